@@ -0,0 +1,31 @@
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+
+#include "bench.hxx"
+
+// Every allocation in the process goes through these, so the benchmarks can count them
+static std::atomic<uint64_t> allocation_count = 0;
+
+void* operator new(size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+
+    if (void *memory = malloc(size ? size : 1)) return memory;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept {
+    free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept {
+    free(memory);
+}
+
+namespace Bench {
+
+    uint64_t allocations() {
+        return allocation_count.load(std::memory_order_relaxed);
+    }
+}
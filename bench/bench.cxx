@@ -0,0 +1,202 @@
+#include <map>
+#include <string>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fmt/format.h>
+
+#if __linux__
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+#include "bench.hxx"
+
+namespace Bench {
+
+    volatile uint64_t sink = 0;
+
+    // How much slower than its baseline a case may get before the run fails
+    const double DEFAULT_THRESHOLD = 0.10;
+
+    typedef struct {
+        double rate;
+        uint64_t allocations;
+    } Measurement;
+
+    // The recorded cases, by name
+    static std::map<std::string, Measurement> measurements;
+
+#if __linux__
+
+    CacheMisses::CacheMisses() {
+        perf_event_attr attr = {};
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+
+        fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+
+    CacheMisses::~CacheMisses() {
+        if (fd >= 0) ::close(fd);
+    }
+
+    void CacheMisses::start() {
+        if (fd < 0) return;
+
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+
+    uint64_t CacheMisses::stop() {
+        uint64_t count = 0;
+
+        if (fd < 0) return count;
+
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd, &count, sizeof(count)) != sizeof(count)) count = 0;
+
+        return count;
+    }
+
+#else
+
+    CacheMisses::CacheMisses() : fd(-1) {}
+    CacheMisses::~CacheMisses() {}
+    void CacheMisses::start() {}
+    uint64_t CacheMisses::stop() { return 0; }
+
+#endif
+
+    bool CacheMisses::available() const {
+        return fd >= 0;
+    }
+
+    void report(const char *name, const Result &result, const char *unit, const Result *baseline) {
+        double rate = result.iterations / result.seconds;
+
+        fmt::print("{:<40} {:>14.0f} {}/s", name, rate, unit);
+
+        if (baseline) {
+            fmt::print("  ({:.2f}x)", rate / (baseline->iterations / baseline->seconds));
+        }
+
+        fmt::print("\n");
+    }
+
+    void record(const char *name, const Result &result, uint64_t allocations) {
+        measurements[name] = { result.iterations / result.seconds, allocations };
+    }
+
+    static bool save_baseline(const char *path) {
+        FILE *file = fopen(path, "w");
+        if (!file) return false;
+
+        for (auto &[name, measurement] : measurements) {
+            fmt::print(file, "{} {:.0f} {}\n", name, measurement.rate, measurement.allocations);
+        }
+
+        fclose(file);
+        return true;
+    }
+
+    /**
+     * Compare the recorded cases against a saved baseline.
+     *
+     * Returns how many of them regressed, or -1 if the baseline couldn't be read.
+     */
+    static int check_baseline(const char *path, double threshold) {
+        FILE *file = fopen(path, "r");
+        if (!file) return -1;
+
+        fmt::print("Against {} (threshold {:.0f}%)\n", path, threshold * 100);
+
+        char name[128];
+        double rate;
+        unsigned long long allocations;
+        int regressions = 0;
+
+        while (fscanf(file, "%127s %lf %llu", name, &rate, &allocations) == 3) {
+            auto it = measurements.find(name);
+
+            if (it == measurements.end()) {
+                fmt::print("  {:<38} not measured\n", name);
+                continue;
+            }
+
+            double change = it->second.rate / rate - 1;
+            bool regressed = change < -threshold || it->second.allocations > allocations;
+
+            fmt::print("  {:<38} {:+7.1f}%  {} -> {} allocations{}\n", name, change * 100,
+                allocations, it->second.allocations, regressed ? "  REGRESSED" : "");
+
+            if (regressed) regressions++;
+        }
+
+        fclose(file);
+        return regressions;
+    }
+}
+
+/**
+ * ffbtool_bench [--save FILE] [--baseline FILE] [--threshold PERCENT]
+ *
+ * `--save` writes the recorded cases' rates and allocations to FILE. `--baseline` checks them
+ * against a file saved earlier, and fails the run if any case got slower by more than the
+ * threshold (10% unless given), or makes more allocations per call. The run also fails if the
+ * parser's output for any descriptor in the corpus differs from the legacy parser's.
+ */
+int main(int argc, char **argv) {
+    const char *save = nullptr;
+    const char *baseline = nullptr;
+    double threshold = Bench::DEFAULT_THRESHOLD;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "--save") == 0) {
+            save = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--baseline") == 0) {
+            baseline = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--threshold") == 0) {
+            threshold = atof(argv[++i]) / 100;
+        } else {
+            fmt::print(stderr, "usage: {} [--save FILE] [--baseline FILE] [--threshold PERCENT]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    bool agreed = Bench::parse_benchmarks();
+    Bench::field_benchmarks();
+
+    if (save && !Bench::save_baseline(save)) {
+        fmt::print(stderr, "Couldn't write {}\n", save);
+        return 2;
+    }
+
+    if (!agreed) {
+        fmt::print("The parser's output no longer matches the legacy parser's\n");
+        return 1;
+    }
+
+    if (baseline) {
+        int regressions = Bench::check_baseline(baseline, threshold);
+
+        if (regressions < 0) {
+            fmt::print(stderr, "Couldn't read {}\n", baseline);
+            return 2;
+        }
+
+        if (regressions > 0) {
+            fmt::print("{} case(s) regressed\n", regressions);
+            return 1;
+        }
+    }
+
+    return 0;
+}
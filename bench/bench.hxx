@@ -0,0 +1,88 @@
+#pragma once
+
+#include <chrono>
+#include <stdint.h>
+
+namespace Bench {
+
+    // How long each case keeps running for
+    const auto RUN_TIME = std::chrono::milliseconds(500);
+
+    typedef struct {
+        uint64_t iterations;
+        double seconds;
+    } Result;
+
+    /**
+     * Keeps results alive so the optimizer can't throw away the work that made them.
+     *
+     * Add to it with `sink = sink + value`, since compound assignment to a volatile is deprecated.
+     */
+    extern volatile uint64_t sink;
+
+    /**
+     * Call `fn` over and over for `RUN_TIME`, in batches so the clock isn't read every time.
+     */
+    template <typename F>
+    Result run(F fn) {
+        using clock = std::chrono::steady_clock;
+
+        uint64_t iterations = 0;
+        uint64_t batch = 1;
+        auto start = clock::now();
+        auto elapsed = clock::duration::zero();
+
+        while (elapsed < RUN_TIME) {
+            for (uint64_t i = 0; i < batch; i++) fn();
+
+            iterations += batch;
+            elapsed = clock::now() - start;
+
+            if (batch < (1 << 16)) batch *= 2;
+        }
+
+        return { iterations, std::chrono::duration<double>(elapsed).count() };
+    }
+
+    /**
+     * Counts hardware cache misses on the calling thread, where the kernel lets us (Linux perf events).
+     */
+    class CacheMisses {
+        public:
+            CacheMisses();
+            ~CacheMisses();
+
+            bool available() const;
+
+            void start();
+
+            // Misses since `start`, or 0 if counting isn't available
+            uint64_t stop();
+
+        private:
+            int fd;
+    };
+
+    /**
+     * Print one line of results: the case, its rate, and how it compares to `baseline` if given.
+     */
+    void report(const char *name, const Result &result, const char *unit, const Result *baseline = nullptr);
+
+    /**
+     * Number of allocations made through `operator new` so far, on any thread.
+     */
+    uint64_t allocations();
+
+    /**
+     * Keep a case's rate and allocations per call, to save as a baseline or check against one.
+     *
+     * `name` must not contain spaces.
+     */
+    void record(const char *name, const Result &result, uint64_t allocations);
+
+    // The groups of cases. `parse_benchmarks` returns false if the parsers disagreed on any descriptor.
+    bool parse_benchmarks();
+    void field_benchmarks();
+    void array_benchmarks();
+    void extract_benchmarks();
+}
@@ -0,0 +1,243 @@
+#pragma once
+
+#include <stddef.h>
+
+namespace Bench {
+
+    typedef struct {
+        const char *name;
+        const unsigned char *data;
+        size_t length;
+    } CorpusEntry;
+
+    // HID 1.11 Appendix B.1: boot keyboard
+    static const unsigned char keyboard[] = {
+        0x05, 0x01, 0x09, 0x06, 0xA1, 0x01, 0x05, 0x07, 0x19, 0xE0, 0x29, 0xE7, 0x15, 0x00, 0x25, 0x01,
+        0x75, 0x01, 0x95, 0x08, 0x81, 0x02, 0x95, 0x01, 0x75, 0x08, 0x81, 0x01, 0x95, 0x05, 0x75, 0x01,
+        0x05, 0x08, 0x19, 0x01, 0x29, 0x05, 0x91, 0x02, 0x95, 0x01, 0x75, 0x03, 0x91, 0x01, 0x95, 0x06,
+        0x75, 0x08, 0x15, 0x00, 0x25, 0x65, 0x05, 0x07, 0x19, 0x00, 0x29, 0x65, 0x81, 0x00, 0xC0,
+    };
+
+    // HID 1.11 Appendix B.2: boot mouse
+    static const unsigned char mouse[] = {
+        0x05, 0x01, 0x09, 0x02, 0xA1, 0x01, 0x09, 0x01, 0xA1, 0x00, 0x05, 0x09, 0x19, 0x01, 0x29, 0x03,
+        0x15, 0x00, 0x25, 0x01, 0x95, 0x03, 0x75, 0x01, 0x81, 0x02, 0x95, 0x01, 0x75, 0x05, 0x81, 0x01,
+        0x05, 0x01, 0x09, 0x30, 0x09, 0x31, 0x15, 0x81, 0x25, 0x7F, 0x75, 0x08, 0x95, 0x02, 0x81, 0x06,
+        0xC0, 0xC0,
+    };
+
+    // Joystick with two numbered input reports
+    static const unsigned char joystick[] = {
+        0x05, 0x01, 0x09, 0x04, 0xA1, 0x01, 0x85, 0x01, 0x15, 0x00, 0x26, 0xFF, 0x00, 0x75, 0x08, 0x95,
+        0x04, 0x09, 0x30, 0x09, 0x31, 0x09, 0x32, 0x09, 0x35, 0x81, 0x02, 0x85, 0x02, 0x75, 0x10, 0x95,
+        0x01, 0x09, 0x36, 0x81, 0x02, 0xC0,
+    };
+
+    // Force feedback wheel with pedals, buttons, a hat and the common PID reports
+    static const unsigned char ffb_wheel[] = {
+        0x05, 0x01, 0x09, 0x04, 0xA1, 0x01, 0x85, 0x01, 0x05, 0x01, 0x09, 0x01, 0xA1, 0x00, 0x09, 0x30,
+        0x15, 0x00, 0x27, 0xFF, 0xFF, 0x00, 0x00, 0x36, 0x7C, 0xFC, 0x46, 0x84, 0x03, 0x55, 0x00, 0x65,
+        0x14, 0x75, 0x10, 0x95, 0x01, 0x81, 0x02, 0x09, 0x31, 0x09, 0x32, 0x09, 0x35, 0x15, 0x00, 0x26,
+        0xFF, 0x0F, 0x75, 0x10, 0x95, 0x03, 0x81, 0x02, 0x65, 0x00, 0x35, 0x00, 0x45, 0x00, 0xC0, 0x05,
+        0x09, 0x19, 0x01, 0x29, 0x18, 0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x18, 0x81, 0x02, 0x05,
+        0x01, 0x09, 0x39, 0x15, 0x00, 0x25, 0x07, 0x35, 0x00, 0x46, 0x3B, 0x01, 0x65, 0x14, 0x75, 0x04,
+        0x95, 0x01, 0x81, 0x42, 0x65, 0x00, 0x75, 0x04, 0x95, 0x01, 0x81, 0x03, 0x05, 0x0F, 0x09, 0x92,
+        0xA1, 0x02, 0x85, 0x02, 0x09, 0x9F, 0x09, 0xA0, 0x09, 0xA4, 0x09, 0xA5, 0x09, 0xA6, 0x15, 0x00,
+        0x25, 0x01, 0x75, 0x01, 0x95, 0x05, 0x81, 0x02, 0x95, 0x03, 0x81, 0x03, 0x09, 0x94, 0x15, 0x00,
+        0x25, 0x01, 0x75, 0x01, 0x95, 0x01, 0x81, 0x02, 0x09, 0x22, 0x15, 0x01, 0x25, 0x28, 0x75, 0x07,
+        0x95, 0x01, 0x81, 0x02, 0xC0, 0x09, 0x21, 0xA1, 0x02, 0x85, 0x01, 0x09, 0x22, 0x15, 0x01, 0x25,
+        0x28, 0x75, 0x08, 0x95, 0x01, 0x91, 0x02, 0x09, 0x25, 0xA1, 0x02, 0x09, 0x26, 0x09, 0x27, 0x09,
+        0x30, 0x09, 0x31, 0x09, 0x32, 0x09, 0x33, 0x09, 0x34, 0x09, 0x40, 0x09, 0x41, 0x09, 0x42, 0x09,
+        0x43, 0x15, 0x01, 0x25, 0x0B, 0x75, 0x08, 0x95, 0x01, 0x91, 0x00, 0xC0, 0x09, 0x50, 0x09, 0x54,
+        0x09, 0x51, 0x09, 0xA7, 0x15, 0x00, 0x26, 0xFF, 0x7F, 0x35, 0x00, 0x46, 0xFF, 0x7F, 0x66, 0x03,
+        0x10, 0x56, 0xFD, 0xFF, 0x75, 0x10, 0x95, 0x04, 0x91, 0x02, 0x65, 0x00, 0x55, 0x00, 0x09, 0x52,
+        0x15, 0x00, 0x26, 0xFF, 0x00, 0x35, 0x00, 0x46, 0x10, 0x27, 0x75, 0x08, 0x95, 0x01, 0x91, 0x02,
+        0x09, 0x53, 0x15, 0x01, 0x25, 0x08, 0x75, 0x08, 0x95, 0x01, 0x91, 0x02, 0x09, 0x55, 0xA1, 0x02,
+        0x05, 0x01, 0x09, 0x30, 0x09, 0x31, 0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x02, 0x91, 0x02,
+        0xC0, 0x05, 0x0F, 0x09, 0x56, 0x95, 0x01, 0x91, 0x02, 0x95, 0x05, 0x91, 0x03, 0x09, 0x57, 0xA1,
+        0x02, 0x05, 0x01, 0x09, 0x30, 0x09, 0x31, 0x65, 0x14, 0x56, 0xFE, 0xFF, 0x15, 0x00, 0x27, 0x9F,
+        0x8C, 0x00, 0x00, 0x35, 0x00, 0x47, 0x9F, 0x8C, 0x00, 0x00, 0x75, 0x10, 0x95, 0x02, 0x91, 0x02,
+        0x65, 0x00, 0x55, 0x00, 0xC0, 0xC0, 0x05, 0x0F, 0x09, 0x5A, 0xA1, 0x02, 0x85, 0x02, 0x09, 0x22,
+        0x15, 0x01, 0x25, 0x28, 0x35, 0x01, 0x45, 0x28, 0x75, 0x08, 0x95, 0x01, 0x91, 0x02, 0x09, 0x5B,
+        0x09, 0x5D, 0x15, 0x00, 0x26, 0x10, 0x27, 0x35, 0x00, 0x46, 0x10, 0x27, 0x75, 0x10, 0x95, 0x02,
+        0x91, 0x02, 0x09, 0x5C, 0x09, 0x5E, 0x66, 0x03, 0x10, 0x56, 0xFD, 0xFF, 0x15, 0x00, 0x26, 0xFF,
+        0x7F, 0x35, 0x00, 0x46, 0xFF, 0x7F, 0x75, 0x10, 0x95, 0x02, 0x91, 0x02, 0x65, 0x00, 0x55, 0x00,
+        0xC0, 0x09, 0x5F, 0xA1, 0x02, 0x85, 0x03, 0x09, 0x22, 0x15, 0x01, 0x25, 0x28, 0x35, 0x01, 0x45,
+        0x28, 0x75, 0x08, 0x95, 0x01, 0x91, 0x02, 0x09, 0x23, 0x15, 0x00, 0x25, 0x01, 0x35, 0x00, 0x45,
+        0x01, 0x75, 0x04, 0x95, 0x01, 0x91, 0x02, 0x09, 0x58, 0xA1, 0x02, 0x19, 0x01, 0x29, 0x02, 0x15,
+        0x01, 0x25, 0x02, 0x75, 0x04, 0x95, 0x01, 0x91, 0x00, 0xC0, 0x09, 0x60, 0x09, 0x61, 0x09, 0x62,
+        0x16, 0xF0, 0xD8, 0x26, 0x10, 0x27, 0x36, 0xF0, 0xD8, 0x46, 0x10, 0x27, 0x75, 0x10, 0x95, 0x03,
+        0x91, 0x02, 0x09, 0x63, 0x09, 0x64, 0x15, 0x00, 0x26, 0x10, 0x27, 0x35, 0x00, 0x46, 0x10, 0x27,
+        0x75, 0x10, 0x95, 0x02, 0x91, 0x02, 0x09, 0x65, 0x15, 0x00, 0x26, 0x10, 0x27, 0x35, 0x00, 0x46,
+        0x10, 0x27, 0x75, 0x10, 0x95, 0x01, 0x91, 0x02, 0xC0, 0x09, 0x6E, 0xA1, 0x02, 0x85, 0x04, 0x09,
+        0x22, 0x15, 0x01, 0x25, 0x28, 0x35, 0x01, 0x45, 0x28, 0x75, 0x08, 0x95, 0x01, 0x91, 0x02, 0x09,
+        0x70, 0x15, 0x00, 0x26, 0x10, 0x27, 0x35, 0x00, 0x46, 0x10, 0x27, 0x75, 0x10, 0x95, 0x01, 0x91,
+        0x02, 0x09, 0x6F, 0x16, 0xF0, 0xD8, 0x26, 0x10, 0x27, 0x36, 0xF0, 0xD8, 0x46, 0x10, 0x27, 0x75,
+        0x10, 0x95, 0x01, 0x91, 0x02, 0x09, 0x71, 0x65, 0x14, 0x56, 0xFE, 0xFF, 0x15, 0x00, 0x27, 0x9F,
+        0x8C, 0x00, 0x00, 0x35, 0x00, 0x47, 0x9F, 0x8C, 0x00, 0x00, 0x75, 0x10, 0x95, 0x01, 0x91, 0x02,
+        0x09, 0x72, 0x66, 0x03, 0x10, 0x56, 0xFD, 0xFF, 0x15, 0x00, 0x26, 0xFF, 0x7F, 0x35, 0x00, 0x46,
+        0xFF, 0x7F, 0x75, 0x20, 0x95, 0x01, 0x91, 0x02, 0x65, 0x00, 0x55, 0x00, 0xC0, 0x09, 0x73, 0xA1,
+        0x02, 0x85, 0x05, 0x09, 0x22, 0x15, 0x01, 0x25, 0x28, 0x35, 0x01, 0x45, 0x28, 0x75, 0x08, 0x95,
+        0x01, 0x91, 0x02, 0x09, 0x70, 0x16, 0xF0, 0xD8, 0x26, 0x10, 0x27, 0x36, 0xF0, 0xD8, 0x46, 0x10,
+        0x27, 0x75, 0x10, 0x95, 0x01, 0x91, 0x02, 0xC0, 0x09, 0x77, 0xA1, 0x02, 0x85, 0x0A, 0x09, 0x22,
+        0x15, 0x01, 0x25, 0x28, 0x35, 0x01, 0x45, 0x28, 0x75, 0x08, 0x95, 0x01, 0x91, 0x02, 0x09, 0x78,
+        0xA1, 0x02, 0x09, 0x79, 0x09, 0x7A, 0x09, 0x7B, 0x15, 0x01, 0x25, 0x03, 0x75, 0x08, 0x95, 0x01,
+        0x91, 0x00, 0xC0, 0x09, 0x7C, 0x15, 0x00, 0x26, 0xFF, 0x00, 0x35, 0x00, 0x46, 0xFF, 0x00, 0x75,
+        0x08, 0x95, 0x01, 0x91, 0x02, 0xC0, 0x09, 0x96, 0xA1, 0x02, 0x85, 0x0C, 0x09, 0x97, 0x09, 0x98,
+        0x09, 0x99, 0x09, 0x9A, 0x09, 0x9B, 0x09, 0x9C, 0x15, 0x01, 0x25, 0x06, 0x75, 0x08, 0x95, 0x01,
+        0x91, 0x00, 0xC0, 0x09, 0x7D, 0xA1, 0x02, 0x85, 0x0D, 0x09, 0x7E, 0x15, 0x00, 0x26, 0xFF, 0x00,
+        0x35, 0x00, 0x46, 0x10, 0x27, 0x75, 0x08, 0x95, 0x01, 0x91, 0x02, 0xC0, 0x09, 0xAB, 0xA1, 0x02,
+        0x85, 0x11, 0x09, 0x25, 0xA1, 0x02, 0x09, 0x26, 0x09, 0x27, 0x09, 0x30, 0x09, 0x31, 0x09, 0x32,
+        0x09, 0x33, 0x09, 0x34, 0x09, 0x40, 0x09, 0x41, 0x09, 0x42, 0x09, 0x43, 0x15, 0x01, 0x25, 0x0B,
+        0x75, 0x08, 0x95, 0x01, 0xB1, 0x00, 0xC0, 0x05, 0x01, 0x09, 0x3B, 0x15, 0x00, 0x26, 0xFF, 0x01,
+        0x75, 0x0A, 0x95, 0x01, 0xB1, 0x02, 0x75, 0x06, 0xB1, 0x01, 0xC0, 0x05, 0x0F, 0x09, 0x89, 0xA1,
+        0x02, 0x85, 0x12, 0x09, 0x22, 0x15, 0x01, 0x25, 0x28, 0x35, 0x01, 0x45, 0x28, 0x75, 0x08, 0x95,
+        0x01, 0xB1, 0x02, 0x09, 0x8B, 0xA1, 0x02, 0x09, 0x8C, 0x09, 0x8D, 0x09, 0x8E, 0x15, 0x01, 0x25,
+        0x03, 0x75, 0x08, 0x95, 0x01, 0xB1, 0x00, 0xC0, 0x09, 0xAC, 0x15, 0x00, 0x27, 0xFF, 0xFF, 0x00,
+        0x00, 0x35, 0x00, 0x47, 0xFF, 0xFF, 0x00, 0x00, 0x75, 0x10, 0x95, 0x01, 0xB1, 0x00, 0xC0, 0x09,
+        0x7F, 0xA1, 0x02, 0x85, 0x13, 0x09, 0x80, 0x15, 0x00, 0x27, 0xFF, 0xFF, 0x00, 0x00, 0x35, 0x00,
+        0x47, 0xFF, 0xFF, 0x00, 0x00, 0x75, 0x10, 0x95, 0x01, 0xB1, 0x02, 0x09, 0x83, 0x15, 0x00, 0x26,
+        0xFF, 0x00, 0x35, 0x00, 0x46, 0xFF, 0x00, 0x75, 0x08, 0x95, 0x01, 0xB1, 0x02, 0x09, 0xA9, 0x09,
+        0xAA, 0x15, 0x00, 0x25, 0x01, 0x35, 0x00, 0x45, 0x01, 0x75, 0x01, 0x95, 0x02, 0xB1, 0x02, 0x75,
+        0x06, 0x95, 0x01, 0xB1, 0x03, 0xC0, 0xC0,
+    };
+
+    // Load cell pedals: three simulation axes and a vendor calibration feature report
+    static const unsigned char pedals[] = {
+        0x05, 0x01, 0x09, 0x04, 0xA1, 0x01, 0x05, 0x02, 0x15, 0x00, 0x26, 0xFF, 0x0F, 0x75, 0x10, 0x95,
+        0x01, 0x09, 0xC4, 0x81, 0x02, 0x09, 0xC5, 0x81, 0x02, 0x09, 0xC6, 0x81, 0x02, 0x06, 0x00, 0xFF,
+        0x09, 0x01, 0xA1, 0x02, 0x85, 0x10, 0x09, 0x02, 0x15, 0x00, 0x26, 0xFF, 0x00, 0x75, 0x08, 0x95,
+        0x18, 0xB1, 0x02, 0xC0, 0x85, 0x11, 0x09, 0x03, 0x95, 0x3F, 0xB1, 0x02, 0xC0,
+    };
+
+    // Gamepad with analogue triggers and a vendor rumble output report
+    static const unsigned char gamepad[] = {
+        0x05, 0x01, 0x09, 0x05, 0xA1, 0x01, 0x85, 0x01, 0x09, 0x01, 0xA1, 0x00, 0x09, 0x30, 0x09, 0x31,
+        0x09, 0x33, 0x09, 0x34, 0x16, 0x00, 0x80, 0x26, 0xFF, 0x7F, 0x75, 0x10, 0x95, 0x04, 0x81, 0x02,
+        0xC0, 0x05, 0x02, 0x09, 0xC4, 0x09, 0xC5, 0x15, 0x00, 0x26, 0xFF, 0x03, 0x75, 0x10, 0x95, 0x02,
+        0x81, 0x02, 0x05, 0x01, 0x09, 0x39, 0x15, 0x01, 0x25, 0x08, 0x35, 0x00, 0x46, 0x3B, 0x01, 0x65,
+        0x14, 0x75, 0x04, 0x95, 0x01, 0x81, 0x42, 0x65, 0x00, 0x45, 0x00, 0x95, 0x01, 0x81, 0x03, 0x05,
+        0x09, 0x19, 0x01, 0x29, 0x10, 0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x10, 0x81, 0x02, 0x05,
+        0x06, 0x09, 0x20, 0x15, 0x00, 0x26, 0xFF, 0x00, 0x75, 0x08, 0x95, 0x01, 0x81, 0x02, 0x06, 0x00,
+        0xFF, 0x09, 0x01, 0xA1, 0x02, 0x85, 0x05, 0x09, 0x02, 0x09, 0x03, 0x09, 0x04, 0x09, 0x05, 0x15,
+        0x00, 0x26, 0xFF, 0x00, 0x75, 0x08, 0x95, 0x04, 0x91, 0x02, 0x09, 0x06, 0x15, 0x00, 0x26, 0xFF,
+        0x00, 0x75, 0x08, 0x95, 0x01, 0x91, 0x02, 0xC0, 0xC0,
+    };
+
+    // Vendor-defined configuration interface with 64-byte reports in every direction
+    static const unsigned char vendor[] = {
+        0x06, 0x00, 0xFF, 0x09, 0x01, 0xA1, 0x01, 0x85, 0x01, 0x09, 0x10, 0x15, 0x00, 0x26, 0xFF, 0x00,
+        0x75, 0x08, 0x95, 0x3F, 0x81, 0x02, 0x85, 0x02, 0x09, 0x11, 0x95, 0x3F, 0x91, 0x02, 0x85, 0x03,
+        0x09, 0x12, 0x95, 0x3F, 0xB1, 0x02, 0x85, 0x04, 0x09, 0x13, 0x75, 0x20, 0x95, 0x0F, 0x15, 0x00,
+        0x27, 0xFF, 0xFF, 0xFF, 0x7F, 0xB1, 0x02, 0x85, 0x05, 0x06, 0x31, 0xFF, 0x09, 0x20, 0x15, 0x00,
+        0x25, 0x01, 0x75, 0x01, 0x95, 0x20, 0x81, 0x02, 0xC0,
+    };
+
+    // Keyboard with consumer and system control reports
+    static const unsigned char media_keyboard[] = {
+        0x05, 0x01, 0x09, 0x06, 0xA1, 0x01, 0x85, 0x01, 0x05, 0x07, 0x19, 0xE0, 0x29, 0xE7, 0x15, 0x00,
+        0x25, 0x01, 0x75, 0x01, 0x95, 0x08, 0x81, 0x02, 0x95, 0x01, 0x75, 0x08, 0x81, 0x01, 0x95, 0x05,
+        0x75, 0x01, 0x05, 0x08, 0x19, 0x01, 0x29, 0x05, 0x91, 0x02, 0x95, 0x01, 0x75, 0x03, 0x91, 0x01,
+        0x95, 0x06, 0x75, 0x08, 0x15, 0x00, 0x26, 0xFF, 0x00, 0x05, 0x07, 0x19, 0x00, 0x29, 0xFF, 0x81,
+        0x00, 0xC0, 0x05, 0x0C, 0x09, 0x01, 0xA1, 0x01, 0x85, 0x02, 0x15, 0x00, 0x26, 0x9C, 0x02, 0x19,
+        0x00, 0x2A, 0x9C, 0x02, 0x75, 0x10, 0x95, 0x04, 0x81, 0x00, 0xC0, 0x05, 0x01, 0x09, 0x80, 0xA1,
+        0x01, 0x85, 0x03, 0x19, 0x81, 0x29, 0x83, 0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x03, 0x81,
+        0x02, 0x95, 0x05, 0x81, 0x01, 0xC0,
+    };
+
+    // Force feedback joystick with the full PID report set, including effect allocation
+    static const unsigned char pid_joystick[] = {
+        0x05, 0x01, 0x09, 0x04, 0xA1, 0x01, 0x85, 0x01, 0x09, 0x01, 0xA1, 0x00, 0x09, 0x30, 0x09, 0x31,
+        0x16, 0x00, 0xFE, 0x26, 0xFF, 0x01, 0x75, 0x0A, 0x95, 0x02, 0x81, 0x02, 0xC0, 0x09, 0x35, 0x09,
+        0x36, 0x15, 0x00, 0x26, 0xFF, 0x00, 0x75, 0x08, 0x95, 0x02, 0x81, 0x02, 0x75, 0x04, 0x95, 0x01,
+        0x81, 0x01, 0x09, 0x39, 0x15, 0x00, 0x25, 0x07, 0x35, 0x00, 0x46, 0x3B, 0x01, 0x65, 0x14, 0x75,
+        0x04, 0x95, 0x01, 0x81, 0x42, 0x65, 0x00, 0x45, 0x00, 0x05, 0x09, 0x19, 0x01, 0x29, 0x0C, 0x15,
+        0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x0C, 0x81, 0x02, 0x95, 0x04, 0x81, 0x01, 0x05, 0x0F, 0x09,
+        0x92, 0xA1, 0x02, 0x85, 0x02, 0x09, 0x9F, 0x09, 0xA0, 0x09, 0xA4, 0x09, 0xA5, 0x09, 0xA6, 0x15,
+        0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x05, 0x81, 0x02, 0x95, 0x03, 0x81, 0x03, 0x09, 0x94, 0x95,
+        0x01, 0x81, 0x02, 0x09, 0x22, 0x15, 0x01, 0x25, 0x28, 0x75, 0x07, 0x81, 0x02, 0xC0, 0x09, 0x21,
+        0xA1, 0x02, 0x85, 0x01, 0x09, 0x22, 0x15, 0x01, 0x25, 0x28, 0x75, 0x08, 0x95, 0x01, 0x91, 0x02,
+        0x09, 0x25, 0xA1, 0x02, 0x09, 0x26, 0x09, 0x27, 0x09, 0x28, 0x09, 0x30, 0x09, 0x31, 0x09, 0x32,
+        0x09, 0x33, 0x09, 0x34, 0x09, 0x40, 0x09, 0x41, 0x09, 0x42, 0x09, 0x43, 0x15, 0x01, 0x25, 0x0C,
+        0x75, 0x08, 0x91, 0x00, 0xC0, 0x09, 0x50, 0x09, 0x54, 0x09, 0x51, 0x09, 0xA7, 0x15, 0x00, 0x26,
+        0xFF, 0x7F, 0x46, 0xFF, 0x7F, 0x66, 0x03, 0x10, 0x56, 0xFD, 0xFF, 0x75, 0x10, 0x95, 0x04, 0x91,
+        0x02, 0x65, 0x00, 0x55, 0x00, 0x09, 0x52, 0x15, 0x00, 0x26, 0xFF, 0x00, 0x46, 0x10, 0x27, 0x75,
+        0x08, 0x95, 0x01, 0x91, 0x02, 0x09, 0x53, 0x15, 0x01, 0x25, 0x08, 0x75, 0x08, 0x91, 0x02, 0x09,
+        0x55, 0xA1, 0x02, 0x05, 0x01, 0x09, 0x30, 0x09, 0x31, 0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95,
+        0x02, 0x91, 0x02, 0xC0, 0x05, 0x0F, 0x09, 0x56, 0x95, 0x01, 0x91, 0x02, 0x95, 0x05, 0x91, 0x03,
+        0x09, 0x57, 0xA1, 0x02, 0x05, 0x01, 0x09, 0x30, 0x09, 0x31, 0x65, 0x14, 0x56, 0xFE, 0xFF, 0x15,
+        0x00, 0x27, 0x9F, 0x8C, 0x00, 0x00, 0x47, 0x9F, 0x8C, 0x00, 0x00, 0x75, 0x10, 0x95, 0x02, 0x91,
+        0x02, 0x65, 0x00, 0x55, 0x00, 0xC0, 0x05, 0x0F, 0x09, 0x58, 0xA1, 0x02, 0x05, 0x01, 0x09, 0x30,
+        0x09, 0x31, 0x15, 0x00, 0x26, 0xFF, 0x00, 0x46, 0xFF, 0x00, 0x75, 0x08, 0x95, 0x02, 0x91, 0x02,
+        0xC0, 0xC0, 0x05, 0x0F, 0x09, 0x5A, 0xA1, 0x02, 0x85, 0x02, 0x09, 0x22, 0x15, 0x01, 0x25, 0x28,
+        0x75, 0x08, 0x95, 0x01, 0x91, 0x02, 0x09, 0x5B, 0x09, 0x5D, 0x15, 0x00, 0x26, 0x10, 0x27, 0x46,
+        0x10, 0x27, 0x75, 0x10, 0x95, 0x02, 0x91, 0x02, 0x09, 0x5C, 0x09, 0x5E, 0x66, 0x03, 0x10, 0x56,
+        0xFD, 0xFF, 0x15, 0x00, 0x26, 0xFF, 0x7F, 0x46, 0xFF, 0x7F, 0x75, 0x10, 0x95, 0x02, 0x91, 0x02,
+        0x65, 0x00, 0x55, 0x00, 0xC0, 0x09, 0x5F, 0xA1, 0x02, 0x85, 0x03, 0x09, 0x22, 0x15, 0x01, 0x25,
+        0x28, 0x75, 0x08, 0x95, 0x01, 0x91, 0x02, 0x09, 0x23, 0x15, 0x00, 0x25, 0x01, 0x75, 0x04, 0x91,
+        0x02, 0x75, 0x04, 0x91, 0x03, 0x09, 0x60, 0x09, 0x61, 0x09, 0x62, 0x16, 0xF0, 0xD8, 0x26, 0x10,
+        0x27, 0x36, 0xF0, 0xD8, 0x46, 0x10, 0x27, 0x75, 0x10, 0x95, 0x03, 0x91, 0x02, 0x09, 0x63, 0x09,
+        0x64, 0x09, 0x65, 0x15, 0x00, 0x26, 0x10, 0x27, 0x35, 0x00, 0x46, 0x10, 0x27, 0x75, 0x10, 0x95,
+        0x03, 0x91, 0x02, 0xC0, 0x09, 0x6E, 0xA1, 0x02, 0x85, 0x04, 0x09, 0x22, 0x15, 0x01, 0x25, 0x28,
+        0x75, 0x08, 0x95, 0x01, 0x91, 0x02, 0x09, 0x70, 0x15, 0x00, 0x26, 0x10, 0x27, 0x75, 0x10, 0x91,
+        0x02, 0x09, 0x6F, 0x16, 0xF0, 0xD8, 0x26, 0x10, 0x27, 0x36, 0xF0, 0xD8, 0x91, 0x02, 0x35, 0x00,
+        0x09, 0x71, 0x65, 0x14, 0x56, 0xFE, 0xFF, 0x15, 0x00, 0x27, 0x9F, 0x8C, 0x00, 0x00, 0x47, 0x9F,
+        0x8C, 0x00, 0x00, 0x91, 0x02, 0x09, 0x72, 0x66, 0x03, 0x10, 0x56, 0xFD, 0xFF, 0x15, 0x00, 0x26,
+        0xFF, 0x7F, 0x46, 0xFF, 0x7F, 0x75, 0x20, 0x91, 0x02, 0x65, 0x00, 0x55, 0x00, 0xC0, 0x09, 0x73,
+        0xA1, 0x02, 0x85, 0x05, 0x09, 0x22, 0x15, 0x01, 0x25, 0x28, 0x75, 0x08, 0x95, 0x01, 0x91, 0x02,
+        0x09, 0x70, 0x16, 0xF0, 0xD8, 0x26, 0x10, 0x27, 0x36, 0xF0, 0xD8, 0x46, 0x10, 0x27, 0x75, 0x10,
+        0x91, 0x02, 0xC0, 0x09, 0x74, 0xA1, 0x02, 0x85, 0x06, 0x09, 0x22, 0x15, 0x01, 0x25, 0x28, 0x35,
+        0x01, 0x45, 0x28, 0x75, 0x08, 0x95, 0x01, 0x91, 0x02, 0x09, 0x75, 0x09, 0x76, 0x16, 0xF0, 0xD8,
+        0x26, 0x10, 0x27, 0x36, 0xF0, 0xD8, 0x46, 0x10, 0x27, 0x75, 0x10, 0x95, 0x02, 0x91, 0x02, 0xC0,
+        0x09, 0x68, 0xA1, 0x02, 0x85, 0x07, 0x09, 0x22, 0x15, 0x01, 0x25, 0x28, 0x35, 0x01, 0x45, 0x28,
+        0x75, 0x08, 0x95, 0x01, 0x91, 0x02, 0x09, 0x6C, 0x15, 0x00, 0x26, 0x10, 0x27, 0x35, 0x00, 0x46,
+        0x10, 0x27, 0x75, 0x10, 0x91, 0x02, 0x09, 0x69, 0x15, 0x81, 0x25, 0x7F, 0x35, 0x00, 0x46, 0xFF,
+        0x00, 0x75, 0x08, 0x95, 0x0C, 0x91, 0x02, 0xC0, 0x09, 0x66, 0xA1, 0x02, 0x85, 0x08, 0x05, 0x01,
+        0x09, 0x30, 0x09, 0x31, 0x15, 0x81, 0x25, 0x7F, 0x35, 0x00, 0x46, 0xFF, 0x00, 0x75, 0x08, 0x95,
+        0x02, 0x91, 0x02, 0xC0, 0x05, 0x0F, 0x09, 0x77, 0xA1, 0x02, 0x85, 0x0A, 0x09, 0x22, 0x15, 0x01,
+        0x25, 0x28, 0x35, 0x01, 0x45, 0x28, 0x75, 0x08, 0x95, 0x01, 0x91, 0x02, 0x09, 0x78, 0xA1, 0x02,
+        0x09, 0x79, 0x09, 0x7A, 0x09, 0x7B, 0x15, 0x01, 0x25, 0x03, 0x75, 0x08, 0x91, 0x00, 0xC0, 0x09,
+        0x7C, 0x15, 0x00, 0x26, 0xFF, 0x00, 0x46, 0xFF, 0x00, 0x91, 0x02, 0xC0, 0x09, 0x90, 0xA1, 0x02,
+        0x85, 0x0B, 0x09, 0x22, 0x15, 0x01, 0x25, 0x28, 0x35, 0x01, 0x45, 0x28, 0x75, 0x08, 0x95, 0x01,
+        0x91, 0x02, 0xC0, 0x09, 0x96, 0xA1, 0x02, 0x85, 0x0C, 0x09, 0x97, 0x09, 0x98, 0x09, 0x99, 0x09,
+        0x9A, 0x09, 0x9B, 0x09, 0x9C, 0x15, 0x01, 0x25, 0x06, 0x75, 0x08, 0x95, 0x01, 0x91, 0x00, 0xC0,
+        0x09, 0x7D, 0xA1, 0x02, 0x85, 0x0D, 0x09, 0x7E, 0x15, 0x00, 0x26, 0xFF, 0x00, 0x35, 0x00, 0x46,
+        0x10, 0x27, 0x75, 0x08, 0x95, 0x01, 0x91, 0x02, 0xC0, 0x09, 0x6B, 0xA1, 0x02, 0x85, 0x0E, 0x09,
+        0x22, 0x15, 0x01, 0x25, 0x28, 0x35, 0x01, 0x45, 0x28, 0x75, 0x08, 0x95, 0x01, 0x91, 0x02, 0x09,
+        0x6D, 0x15, 0x00, 0x26, 0xFF, 0x00, 0x46, 0xFF, 0x00, 0x91, 0x02, 0x09, 0x51, 0x66, 0x03, 0x10,
+        0x56, 0xFD, 0xFF, 0x15, 0x00, 0x26, 0xFF, 0x7F, 0x46, 0xFF, 0x7F, 0x75, 0x10, 0x91, 0x02, 0x65,
+        0x00, 0x55, 0x00, 0xC0, 0x09, 0xAB, 0xA1, 0x02, 0x85, 0x01, 0x09, 0x25, 0xA1, 0x02, 0x09, 0x26,
+        0x09, 0x27, 0x09, 0x28, 0x09, 0x30, 0x09, 0x31, 0x09, 0x32, 0x09, 0x33, 0x09, 0x34, 0x09, 0x40,
+        0x09, 0x41, 0x09, 0x42, 0x09, 0x43, 0x15, 0x01, 0x25, 0x0C, 0x35, 0x01, 0x45, 0x0C, 0x75, 0x08,
+        0x95, 0x01, 0xB1, 0x00, 0xC0, 0x05, 0x01, 0x09, 0x3B, 0x15, 0x00, 0x26, 0xFF, 0x01, 0x35, 0x00,
+        0x46, 0xFF, 0x01, 0x75, 0x0A, 0xB1, 0x02, 0x75, 0x06, 0xB1, 0x01, 0xC0, 0x05, 0x0F, 0x09, 0x89,
+        0xA1, 0x02, 0x85, 0x02, 0x09, 0x22, 0x15, 0x01, 0x25, 0x28, 0x35, 0x01, 0x45, 0x28, 0x75, 0x08,
+        0x95, 0x01, 0xB1, 0x02, 0x09, 0x8B, 0xA1, 0x02, 0x09, 0x8C, 0x09, 0x8D, 0x09, 0x8E, 0x15, 0x01,
+        0x25, 0x03, 0x35, 0x01, 0x45, 0x03, 0xB1, 0x00, 0xC0, 0x09, 0xAC, 0x15, 0x00, 0x27, 0xFF, 0xFF,
+        0x00, 0x00, 0x35, 0x00, 0x47, 0xFF, 0xFF, 0x00, 0x00, 0x75, 0x10, 0xB1, 0x02, 0xC0, 0x09, 0x7F,
+        0xA1, 0x02, 0x85, 0x03, 0x09, 0x80, 0x15, 0x00, 0x27, 0xFF, 0xFF, 0x00, 0x00, 0x35, 0x00, 0x47,
+        0xFF, 0xFF, 0x00, 0x00, 0x75, 0x10, 0x95, 0x01, 0xB1, 0x02, 0x09, 0x83, 0x15, 0x00, 0x26, 0xFF,
+        0x00, 0x35, 0x00, 0x46, 0xFF, 0x00, 0x75, 0x08, 0xB1, 0x02, 0x09, 0xA9, 0x09, 0xAA, 0x15, 0x00,
+        0x25, 0x01, 0x35, 0x00, 0x45, 0x01, 0x75, 0x01, 0x95, 0x02, 0xB1, 0x02, 0x75, 0x06, 0x95, 0x01,
+        0xB1, 0x03, 0xC0, 0xC0,
+    };
+
+    #define CORPUS_ENTRY(NAME) { #NAME, NAME, sizeof(NAME) }
+
+    /**
+     * Report descriptors the benchmarks run over
+     */
+    static const CorpusEntry corpus[] = {
+        CORPUS_ENTRY(keyboard),
+        CORPUS_ENTRY(mouse),
+        CORPUS_ENTRY(joystick),
+        CORPUS_ENTRY(ffb_wheel),
+        CORPUS_ENTRY(pedals),
+        CORPUS_ENTRY(gamepad),
+        CORPUS_ENTRY(vendor),
+        CORPUS_ENTRY(media_keyboard),
+        CORPUS_ENTRY(pid_joystick),
+    };
+
+    #undef CORPUS_ENTRY
+}
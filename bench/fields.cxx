@@ -0,0 +1,272 @@
+#include <string.h>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "bench.hxx"
+#include "hid_descriptor.hxx"
+#include "usage_set.hxx"
+
+namespace Bench {
+
+    using namespace HID::Descriptor;
+
+    // Fields in each synthetic descriptor, and how many descriptors are decoded in turn.
+    // Together the node lists come to several MiB, more than a typical L2 holds.
+    const size_t WIDE_FIELDS = 512;
+    const size_t WIDE_DESCRIPTORS = 256;
+
+    /**
+     * A single input report with `fields` button, byte and word fields mixed together.
+     */
+    static std::vector<unsigned char> wide_descriptor(size_t fields) {
+        std::vector<unsigned char> d = { 0x05, 0x01, 0x09, 0x04, 0xA1, 0x01, 0x05, 0x09 };
+        const uint8_t sizes[] = { 1, 8, 16, 8 };
+
+        for (size_t i = 0; i < fields / 8; i++) {
+            uint8_t size = sizes[i % 4];
+
+            d.insert(d.end(), {
+                0x19, 0x01,          // Usage Minimum (1)
+                0x29, 0x08,          // Usage Maximum (8)
+                0x15, 0x00,          // Logical Minimum (0)
+                0x75, size,          // Report Size
+                0x95, 0x08,          // Report Count (8)
+                0x81, 0x02,          // Input (Data, Variable, Absolute)
+            });
+        }
+
+        d.push_back(0xC0);
+        return d;
+    }
+
+    // Key slots in the synthetic N-key rollover keyboard
+    const size_t ROLLOVER_KEYS = 62;
+
+    /**
+     * A keyboard report with a modifier byte and `keys` slots of an array over usages 0 - 255.
+     */
+    static std::vector<unsigned char> rollover_descriptor(size_t keys) {
+        return {
+            0x05, 0x01, 0x09, 0x06, 0xA1, 0x01, // Usage Page (Generic Desktop), Usage (Keyboard), Collection (Application)
+            0x85, 0x01,                         // Report ID (1)
+            0x05, 0x07, 0x19, 0xE0, 0x29, 0xE7, // Usage Page (Keyboard), Usage Minimum (0xE0), Usage Maximum (0xE7)
+            0x15, 0x00, 0x25, 0x01,             // Logical Minimum (0), Logical Maximum (1)
+            0x75, 0x01, 0x95, 0x08, 0x81, 0x02, // Report Size (1), Report Count (8), Input (Data, Variable, Absolute)
+            0x19, 0x00, 0x2A, 0xFF, 0x00,       // Usage Minimum (0), Usage Maximum (255)
+            0x26, 0xFF, 0x00,                   // Logical Maximum (255)
+            0x75, 0x08, 0x95, (unsigned char)keys, 0x81, 0x00, // Report Size (8), Report Count (keys), Input (Data, Array, Absolute)
+            0xC0,
+        };
+    }
+
+    /**
+     * The reader fields were taken with before `HID::extract_bits`: unsigned only, and it
+     * trusts the buffer to have a whole word past every field. Kept as a baseline.
+     */
+    static inline int32_t read_bits(const unsigned char *data, uint32_t offset, uint8_t size) {
+        uint64_t raw;
+        memcpy(&raw, data + offset / 8, sizeof(raw));
+
+        return (int32_t)((raw >> (offset % 8)) & ((1ull << size) - 1));
+    }
+
+    void field_benchmarks() {
+        fmt::print("Field iteration ({} descriptors of {} fields)\n", WIDE_DESCRIPTORS, WIDE_FIELDS);
+
+        auto bytes = wide_descriptor(WIDE_FIELDS);
+
+        // Parsed separately so each descriptor's tables sit in their own memory, as they would for separate devices
+        std::vector<Descriptor> descriptors;
+        for (size_t i = 0; i < WIDE_DESCRIPTORS; i++) descriptors.push_back(parse(bytes.data(), bytes.size()));
+
+        // Padded so reads of the last field can take a whole word
+        std::vector<unsigned char> data(descriptors[0].max_report_length(MainItemTag::INPUT) + 8);
+        for (size_t i = 0; i < data.size(); i++) data[i] = (unsigned char)(i * 37);
+
+        CacheMisses misses;
+        size_t next = 0;
+
+        misses.start();
+        auto nodes = run([&] {
+            auto &inputs = descriptors[next++ % WIDE_DESCRIPTORS].inputs;
+            int64_t total = 0;
+
+            for (auto &node : inputs) {
+                total += HID::extract_bits(data.data(), data.size(), node.report_index, node.report_size, node.min_value < 0) + node.min_value;
+            }
+
+            sink = sink + total;
+        });
+        uint64_t node_misses = misses.stop();
+
+        misses.start();
+        auto columns = run([&] {
+            auto &fields = descriptors[next++ % WIDE_DESCRIPTORS].input_fields;
+            int64_t total = 0;
+
+            for (size_t row = 0; row < fields.size(); row++) {
+                total += HID::extract_bits(data.data(), data.size(), fields.offsets[row], fields.sizes[row], fields.logical_mins[row] < 0) + fields.logical_mins[row];
+            }
+
+            sink = sink + total;
+        });
+        uint64_t column_misses = misses.stop();
+
+        report("  nodes", nodes, "descriptors");
+        report("  field table", columns, "descriptors", &nodes);
+
+        if (misses.available()) {
+            double per_node = (double)node_misses / (nodes.iterations * WIDE_FIELDS);
+            double per_column = (double)column_misses / (columns.iterations * WIDE_FIELDS);
+
+            fmt::print("  cache misses per field: nodes {:.4f}, field table {:.4f}\n", per_node, per_column);
+        } else {
+            fmt::print("  cache misses: not available (perf events unsupported or not permitted)\n");
+        }
+
+        array_benchmarks();
+        extract_benchmarks();
+    }
+
+    void array_benchmarks() {
+        fmt::print("Array decoding ({} key rollover keyboard)\n", ROLLOVER_KEYS);
+
+        auto bytes = rollover_descriptor(ROLLOVER_KEYS);
+        Descriptor descriptor = parse(bytes.data(), bytes.size());
+        const ArrayField &array = descriptor.arrays[0];
+        const FieldTable &fields = descriptor.input_fields;
+
+        // A handful of keys held, the rest of the slots empty
+        std::vector<unsigned char> data(descriptor.max_report_length(MainItemTag::INPUT) + 8);
+        data[0] = 1;
+        data[1] = 0x02;
+        const unsigned char held[] = { 0x04, 0x16, 0x1A, 0x2C, 0x07, 0x52 };
+        memcpy(data.data() + 2, held, sizeof(held));
+
+        // Each slot read as a field of its own, as the node list has it
+        std::vector<bool> slots(256);
+        auto fields_result = run([&] {
+            std::fill(slots.begin(), slots.end(), false);
+
+            for (uint32_t row = array.first_field; row < array.first_field + array.count; row++) {
+                int32_t value = HID::extract_bits(data.data() + 1, data.size() - 1, fields.offsets[row], fields.sizes[row], fields.logical_mins[row] < 0);
+
+                if (value >= fields.logical_mins[row] && value <= fields.logical_maxs[row]) {
+                    uint16_t usage = descriptor.array_usage(array, value - fields.logical_mins[row]);
+                    if (usage != 0) slots[value - fields.logical_mins[row]] = true;
+                }
+            }
+
+            sink = sink + slots[0x04];
+        });
+
+        HID::UsageSet pressed, before, came_on, went_off;
+        before.resize(256);
+
+        auto decoded = run([&] {
+            HID::decode_array(descriptor, array, data.data(), data.size(), pressed);
+            sink = sink + pressed.test(0x04);
+        });
+
+        auto diffed = run([&] {
+            HID::decode_array(descriptor, array, data.data(), data.size(), pressed);
+            HID::UsageSet::diff(before, pressed, came_on, went_off);
+            sink = sink + came_on.count();
+        });
+
+        uint64_t start = allocations();
+        HID::decode_array(descriptor, array, data.data(), data.size(), pressed);
+        HID::UsageSet::diff(before, pressed, came_on, went_off);
+        uint64_t decode_allocations = allocations() - start;
+
+        report("  slot fields", fields_result, "reports");
+        report("  decode_array", decoded, "reports", &fields_result);
+        report("  decode_array + diff", diffed, "reports", &fields_result);
+
+        record("array/decode", decoded, decode_allocations);
+        record("array/decode_diff", diffed, decode_allocations);
+    }
+
+    void extract_benchmarks() {
+        fmt::print("Field extraction ({} fields)\n", WIDE_FIELDS);
+
+        auto bytes = wide_descriptor(WIDE_FIELDS);
+        Descriptor descriptor = parse(bytes.data(), bytes.size());
+        const FieldTable &fields = descriptor.input_fields;
+
+        // Padded for the unchecked reader, which takes a whole word past every field
+        size_t length = descriptor.max_report_length(MainItemTag::INPUT);
+        std::vector<unsigned char> data(length + 8);
+        for (size_t i = 0; i < data.size(); i++) data[i] = (unsigned char)(i * 37);
+
+        // Both readers must agree on unsigned fields before their speed means anything
+        size_t mismatches = 0;
+        for (size_t row = 0; row < fields.size(); row++) {
+            int32_t expected = read_bits(data.data(), fields.offsets[row], fields.sizes[row]);
+            if (HID::extract_bits(data.data(), length, fields.offsets[row], fields.sizes[row], false) != expected) mismatches++;
+        }
+
+        if (mismatches != 0) fmt::print("  readers disagree on {} fields\n", mismatches);
+
+        auto unchecked = run([&] {
+            int64_t total = 0;
+
+            for (size_t row = 0; row < fields.size(); row++) {
+                total += read_bits(data.data(), fields.offsets[row], fields.sizes[row]);
+            }
+
+            sink = sink + total;
+        });
+
+        auto checked = run([&] {
+            int64_t total = 0;
+
+            for (size_t row = 0; row < fields.size(); row++) {
+                total += HID::extract_bits(data.data(), length, fields.offsets[row], fields.sizes[row], false);
+            }
+
+            sink = sink + total;
+        });
+
+        auto sign_extended = run([&] {
+            int64_t total = 0;
+
+            for (size_t row = 0; row < fields.size(); row++) {
+                total += HID::extract_bits(data.data(), length, fields.offsets[row], fields.sizes[row], true);
+            }
+
+            sink = sink + total;
+        });
+
+        // Every field checked against the layout and the padded buffer up front, so a report
+        // only needs its own length checked
+        bool fits = true;
+
+        for (size_t row = 0; row < fields.size(); row++) {
+            fits &= HID::fits_unchecked(data.size(), fields.offsets[row], fields.sizes[row]);
+            fits &= fields.offsets[row] + fields.sizes[row] <= length * 8;
+        }
+
+        auto checked_once = run([&] {
+            int64_t total = 0;
+
+            if (fits) {
+                for (size_t row = 0; row < fields.size(); row++) {
+                    total += HID::extract_bits_unchecked(data.data(), fields.offsets[row], fields.sizes[row], false);
+                }
+            }
+
+            sink = sink + total;
+        });
+
+        report("  unchecked read", unchecked, "reports");
+        report("  extract_bits", checked, "reports", &unchecked);
+        report("  extract_bits (signed)", sign_extended, "reports", &unchecked);
+        report("  checked once per report", checked_once, "reports", &unchecked);
+
+        record("extract/unsigned", checked, 0);
+        record("extract/signed", sign_extended, 0);
+        record("extract/checked_once", checked_once, 0);
+    }
+}
@@ -0,0 +1,267 @@
+#include <algorithm>
+#include <array>
+#include <assert.h>
+#include <map>
+#include <vector>
+
+#include "hid_descriptor.hxx"
+#include "legacy_parser.hxx"
+
+using namespace HID::Descriptor;
+
+// Kept as it was, so warnings from its own code are silenced here rather than fixed
+#if defined(__GNUC__)
+    #pragma GCC diagnostic ignored "-Wunused-parameter"
+    #pragma GCC diagnostic ignored "-Wunused-variable"
+    #pragma GCC diagnostic ignored "-Wmissing-field-initializers"
+    #pragma GCC diagnostic ignored "-Wswitch"
+#endif
+
+/**
+ * The descriptor parser as it was before its state went into fixed-capacity
+ * stacks, kept so the benchmark has something to compare against. Usage and
+ * string ranges are assigned in order, as the parser now does, so the two
+ * still agree on every descriptor.
+ */
+class LegacyParser {
+    public:
+        Descriptor parse(const unsigned char *buffer, size_t buffer_sz);
+
+    private:
+        using GlobalParams = std::array<int32_t, 10>;
+        using LocalParams = std::map<LocalItemTag, std::vector<int32_t>>;
+
+        std::vector<GlobalParams> globals;
+        LocalParams locals;
+        uint32_t index;
+        uint8_t collection_depth;
+        Descriptor descriptor;
+
+        void main_item(uint8_t tag, uint8_t data_sz, int32_t data);
+        void global_item(uint8_t tag, int32_t data);
+        void local_item(uint8_t tag, int32_t data);
+        void node(uint8_t data_sz, int32_t data, MainItemTag type);
+};
+
+static int32_t legacy_item_data(const uint8_t *buffer, uint8_t item_sz) {
+    if (item_sz == 1) return *buffer;
+    if (item_sz == 2) return *((int16_t*)buffer);
+    if (item_sz == 4) return *((int32_t*)buffer);
+    return 0;
+}
+
+static uint8_t legacy_item_size(uint8_t item) {
+    uint8_t maskedSize = item & SIZE_MASK;
+
+    return (maskedSize == 3 ? 4 : maskedSize);
+}
+
+Descriptor legacy_parse(const unsigned char *buffer, size_t buffer_sz) {
+    LegacyParser parser;
+    return parser.parse(buffer, buffer_sz);
+}
+
+Descriptor LegacyParser::parse(const unsigned char *buffer, size_t buffer_sz) {
+    size_t idx = 0;
+
+    index = 0;
+    collection_depth = 0;
+    descriptor = {};
+    locals.clear();
+
+    globals.clear();
+    globals.reserve(2);
+    globals.push_back({});
+
+    while(idx < buffer_sz) {
+        uint8_t mark = buffer[idx];
+        uint8_t item_sz  = legacy_item_size(buffer[idx] & SIZE_MASK);
+
+        // A truncated descriptor ends at its last complete item
+        if (idx + 1 + item_sz > buffer_sz) break;
+
+        int32_t data = legacy_item_data(&buffer[idx+1], item_sz);
+
+        ReportItemType item_type = (ReportItemType)(mark & TYPE_MASK);
+        uint8_t tag = mark >> 4;
+
+        switch (item_type) {
+            case ReportItemType::MAIN_ITEM:
+                main_item(tag, item_sz, data);
+
+                // Local items only ever apply to the main item which follows them
+                locals.clear();
+                break;
+            case ReportItemType::GLOBAL_ITEM:
+                global_item(tag, data);
+                break;
+            case ReportItemType::LOCAL_ITEM:
+                local_item(tag, data);
+            default:
+                break;
+        }
+
+        idx += item_sz + 1;
+    }
+
+    return std::move(descriptor);
+}
+
+void LegacyParser::global_item(uint8_t tag, int32_t data) {
+    assert(tag <= GlobalItemTag::POP);
+
+    auto p = globals.back();
+
+    switch(tag) {
+        case GlobalItemTag::PUSH:
+            globals.push_back(p);
+            break;
+        case GlobalItemTag::POP:
+            if (globals.size() > 1) globals.pop_back();
+            break;
+        default:
+            // Reserved tags have nowhere to go
+            if (tag >= p.size()) break;
+
+            globals.pop_back();
+            p[tag] = data;
+            globals.push_back(p);
+            break;
+    }
+}
+
+void LegacyParser::main_item(uint8_t tag, uint8_t data_sz, int32_t data) {
+    assert(tag <= MainItemTag::END_COLLECTION);
+
+    switch (tag) {
+        case MainItemTag::INPUT:
+        case MainItemTag::OUTPUT:
+        case MainItemTag::FEATURE:
+            node(data_sz, data, (MainItemTag)tag);
+            break;
+        case MainItemTag::COLLECTION:
+            collection_depth++;
+            break;
+        case MainItemTag::END_COLLECTION: 
+            if (collection_depth > 0) collection_depth--;
+            break;
+    }
+}
+
+void LegacyParser::local_item(uint8_t tag, int32_t data) {
+    LocalItemTag t = (LocalItemTag) tag;
+
+    if ( locals.contains(t) ) {
+        locals.at(t).push_back(data);
+        std::rotate(locals.at(t).rbegin(), locals.at(t).rbegin() + 1, locals.at(t).rend());
+    } else {
+        std::vector<int32_t> value = { data };
+        locals.emplace(t, value);
+    }
+}
+
+void LegacyParser::node(uint8_t data_sz, int32_t data, MainItemTag tag) {
+    const GlobalParams &params = globals.back();
+
+    int32_t report_count = params[GlobalItemTag::REPORT_COUNT],
+            report_id = params[GlobalItemTag::REPORT_ID],
+            report_size = params[GlobalItemTag::REPORT_SIZE],
+            logical_min = params[GlobalItemTag::LOGICAL_MINIMUM],
+            logical_max = params[GlobalItemTag::LOGICAL_MAXIMUM],
+            physical_min = params[GlobalItemTag::PHYSICAL_MINIMUM],
+            physical_max = params[GlobalItemTag::PHYSICAL_MAXIMUM],
+            units = params[GlobalItemTag::UNIT],
+            unit_exp = params[GlobalItemTag::UNIT_EXPONENT];
+
+    auto usage_min_it = locals.find(LocalItemTag::UsageMin),
+         usage_max_it = locals.find(LocalItemTag::UsageMax),
+         string_min_it = locals.find(LocalItemTag::StringMin),
+         string_max_it = locals.find(LocalItemTag::StringMax);
+
+    uint16_t usage_id = 0,
+             usage_min = 0,
+             usage_max = 0;
+
+    uint16_t string_id = 0,
+            string_min = 0,
+            string_max = 0;
+
+    bool usage_range = false, string_range = false;
+
+    if (usage_min_it != locals.end() && usage_max_it != locals.end()) {
+        if (!usage_min_it->second.empty() && !usage_max_it->second.empty()) {
+            usage_range = true;
+            usage_max = (uint16_t) usage_max_it->second.back();
+            usage_min = (uint16_t) usage_min_it->second.back();
+
+            usage_max_it->second.pop_back();
+            usage_min_it->second.pop_back();
+        }
+    }
+
+    if (string_min_it != locals.end() && string_max_it != locals.end()) {
+        if (!string_max_it->second.empty() && !string_min_it->second.empty()) {
+            string_range = true;
+            string_max = (uint16_t) string_max_it->second.back();
+            string_min = (uint16_t) string_min_it->second.back();
+
+            string_min_it->second.pop_back();
+            string_max_it->second.pop_back();
+        }
+    }
+
+    for (auto i = 0; i < report_count; i++) {
+        if (usage_range) {
+            usage_id = (uint16_t)std::min<uint32_t>(usage_min + i, usage_max);
+        } else {
+            auto usage = locals.find(LocalItemTag::Usage);
+
+            if (usage != locals.end()) {
+                if (!usage->second.empty()) {
+                    usage_id = usage->second.back();
+                    usage->second.pop_back();
+                }
+            }
+        }
+
+        if (string_range) {
+            string_id = (uint16_t)std::min<uint32_t>(string_min + i, string_max);
+        } else {
+            auto str = locals.find(LocalItemTag::StringIndex);
+
+            if (str != locals.end() && !str->second.empty()) {
+                string_id = str->second.back();
+                str->second.pop_back();
+            } else {
+                string_id = 0xffff;
+            }
+        }
+
+        Node v = {
+            .usage_page = (UsagePage)params[GlobalItemTag::USAGE_PAGE],
+            .report_id = (uint16_t)report_id,
+            .usage_id = usage_id,
+            .string_index = string_id,
+            .report_size = (uint8_t)report_size,
+            .report_index = index,
+            .min_value = logical_min,
+            .max_value = logical_max,
+            .physical_min = physical_min,
+            .physical_max = physical_max,
+        };
+
+        switch(tag) {
+            case MainItemTag::INPUT:
+                descriptor.inputs.push_back(v);
+                break;
+            case MainItemTag::OUTPUT:
+                descriptor.outputs.push_back(v);
+                break;
+            case MainItemTag::FEATURE:
+                descriptor.features.push_back(v);
+                break;
+        }
+
+        index += report_size;
+    }
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include "hid_descriptor.hxx"
+
+/**
+ * Parse with the original map-and-vector parser, for comparison.
+ */
+HID::Descriptor::Descriptor legacy_parse(const unsigned char *buffer, size_t buffer_sz);
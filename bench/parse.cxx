@@ -0,0 +1,117 @@
+#include <string.h>
+
+#include <fmt/format.h>
+
+#include "bench.hxx"
+#include "corpus.hxx"
+#include "hid_descriptor.hxx"
+#include "legacy_parser.hxx"
+
+namespace Bench {
+
+    using namespace HID::Descriptor;
+
+    /**
+     * Whether two values read from the same item match. The legacy parser zero-extended
+     * 1-byte item data and sign-extended 2-byte data, where the parser now extends each
+     * item by what it means, so values which only differ in how they were extended do.
+     */
+    static bool same_data(uint32_t legacy, uint32_t current) {
+        if (legacy == current) return true;
+
+        for (uint32_t bits : { 8u, 16u }) {
+            uint32_t mask = (1u << bits) - 1;
+            auto extended = [&](uint32_t value) { return (value & ~mask) == 0 || (value & ~mask) == ~mask; };
+
+            if ((legacy & mask) == (current & mask) && extended(legacy) && extended(current)) return true;
+        }
+
+        return false;
+    }
+
+    // Bit offsets aren't compared, since the legacy parser ran them on across every report
+    static bool same_nodes(const std::vector<Node> &a, const std::vector<Node> &b) {
+        if (a.size() != b.size()) return false;
+
+        for (size_t i = 0; i < a.size(); i++) {
+            if (!same_data((uint32_t)a[i].usage_page, (uint32_t)b[i].usage_page) || !same_data(a[i].usage_id, b[i].usage_id)
+                || a[i].report_id != b[i].report_id || a[i].report_size != b[i].report_size
+                || a[i].string_index != b[i].string_index
+                || !same_data(a[i].min_value, b[i].min_value) || !same_data(a[i].max_value, b[i].max_value)
+                || !same_data(a[i].physical_min, b[i].physical_min) || !same_data(a[i].physical_max, b[i].physical_max)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool parse_benchmarks() {
+        fmt::print("Descriptor parsing\n");
+
+        bool agreed = true;
+
+        for (auto &entry : corpus) {
+            Descriptor expected = legacy_parse(entry.data, entry.length);
+            Descriptor actual = parse(entry.data, entry.length);
+
+            if (!same_nodes(expected.inputs, actual.inputs) || !same_nodes(expected.outputs, actual.outputs)
+                || !same_nodes(expected.features, actual.features)) {
+                fmt::print("  {}: parsers disagree\n", entry.name);
+                agreed = false;
+            }
+
+            auto legacy = run([&] {
+                sink = sink + legacy_parse(entry.data, entry.length).inputs.size();
+            });
+
+            Parser parser;
+            auto current = run([&] {
+                sink = sink + parser.parse(entry.data, entry.length).inputs.size();
+            });
+
+            uint64_t before = allocations();
+            sink = sink + legacy_parse(entry.data, entry.length).inputs.size();
+            uint64_t legacy_allocations = allocations() - before;
+
+            before = allocations();
+            sink = sink + parser.parse(entry.data, entry.length).inputs.size();
+            uint64_t current_allocations = allocations() - before;
+
+            fmt::print("  {} ({} bytes, {} inputs, {} outputs, {} features)\n", entry.name, entry.length,
+                actual.inputs.size(), actual.outputs.size(), actual.features.size());
+
+            report("    legacy", legacy, "descriptors");
+            report("    parser", current, "descriptors", &legacy);
+            fmt::print("    allocations per parse: legacy {}, parser {}\n", legacy_allocations, current_allocations);
+
+            record(fmt::format("parse/{}", entry.name).c_str(), current, current_allocations);
+
+            // Questions which can be answered from the items alone, without building the descriptor
+            const struct {
+                const char *name;
+                const char *label;
+                uint64_t (*answer)(const unsigned char*, size_t);
+            } queries[] = {
+                { "report_ids", "report IDs", [](const unsigned char *data, size_t length) -> uint64_t { return report_ids(data, length).size(); } },
+                { "application_usage", "application usage", [](const unsigned char *data, size_t length) -> uint64_t { return application_usage(data, length); } },
+                { "is_pid_device", "PID device", [](const unsigned char *data, size_t length) -> uint64_t { return is_pid_device(data, length); } },
+            };
+
+            for (auto &query : queries) {
+                auto result = run([&] {
+                    sink = sink + query.answer(entry.data, entry.length);
+                });
+
+                before = allocations();
+                sink = sink + query.answer(entry.data, entry.length);
+                uint64_t query_allocations = allocations() - before;
+
+                report(fmt::format("    {}", query.label).c_str(), result, "descriptors", &current);
+                record(fmt::format("{}/{}", query.name, entry.name).c_str(), result, query_allocations);
+            }
+        }
+
+        return agreed;
+    }
+}
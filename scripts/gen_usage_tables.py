@@ -0,0 +1,209 @@
+#!/usr/bin/env python3
+"""
+Generate the usage name tables from the HID Usage Tables source.
+
+    gen_usage_tables.py data/hid_usage_tables.txt usage_tables.hxx
+
+Names are stored once each in a single string pool (a name which is the tail
+of another one points into it), and usages are stored as ranges which refer to
+their name by offset. See `data/hid_usage_tables.txt` for the source format.
+"""
+
+import sys
+
+CONTROL_TYPES = {
+    'LC': 'UCF_LC', 'OOC': 'UCF_OOC', 'MC': 'UCF_MC', 'OSC': 'UCF_OSC', 'RTC': 'UCF_RTC',
+    'Sel': 'UCF_Sel', 'SV': 'UCF_SV', 'SF': 'UCF_SF', 'DV': 'UCF_DV', 'DF': 'UCF_DF',
+    'NAry': 'UCF_NAry', 'CA': 'UCF_CA', 'CL': 'UCF_CL', 'CP': 'UCF_CP', 'US': 'UCF_US', 'UM': 'UCF_UM',
+}
+
+# Names the lookup falls back on for usages without a definition of their own
+FALLBACK_NAMES = {
+    'USAGE_NAME_RESERVED': 'RESERVED',
+    'USAGE_NAME_UNDEFINED': 'UNDEFINED',
+    'USAGE_NAME_VENDOR_DEFINED': 'Vendor-Defined',
+}
+
+
+class SourceError(Exception):
+    pass
+
+
+def parse_id(text, line):
+    try:
+        value = int(text, 16)
+    except ValueError:
+        raise SourceError(f'line {line}: "{text}" is not a hex ID')
+
+    if not 0 <= value <= 0xFFFF:
+        raise SourceError(f'line {line}: {text} is out of range')
+
+    return value
+
+
+def parse_control_types(text, line):
+    if text == '-':
+        return []
+
+    flags = []
+    for name in text.split('/'):
+        if name not in CONTROL_TYPES:
+            raise SourceError(f'line {line}: unknown control type "{name}"')
+        flags.append(CONTROL_TYPES[name])
+
+    return flags
+
+
+def read_source(path):
+    """
+    Read the pages from the source, each as a dict with `id`, `name`, `complete`
+    and `usages`, a list of (min, max, control types, name).
+    """
+    pages = {}
+    page = None
+
+    with open(path, encoding='utf-8') as source:
+        for line, text in enumerate(source, 1):
+            text = text.strip()
+            if not text or text.startswith('#'):
+                continue
+
+            if text.startswith('page '):
+                words = text.split()[1:]
+                if len(words) < 2:
+                    raise SourceError(f'line {line}: a page needs an ID and a name')
+
+                complete = words[-1] == 'complete'
+                if complete:
+                    words = words[:-1]
+
+                page = {'id': parse_id(words[0], line), 'name': ' '.join(words[1:]), 'complete': complete, 'usages': []}
+                if page['id'] in pages:
+                    raise SourceError(f'line {line}: page 0x{page["id"]:02X} is defined twice')
+
+                pages[page['id']] = page
+                continue
+
+            if page is None:
+                raise SourceError(f'line {line}: usage outside of a page')
+
+            words = text.split(None, 2)
+            if len(words) < 3:
+                raise SourceError(f'line {line}: a usage needs an ID, control types and a name')
+
+            ids = words[0].split('-')
+            first = parse_id(ids[0], line)
+            last = parse_id(ids[1], line) if len(ids) > 1 else first
+
+            if last < first:
+                raise SourceError(f'line {line}: range ends before it starts')
+
+            if not words[2].isascii():
+                raise SourceError(f'line {line}: names must be ASCII')
+
+            usages = page['usages']
+            if usages and usages[-1][1] >= first:
+                raise SourceError(f'line {line}: usage 0x{first:02X} is out of order or overlaps the one before it')
+
+            usages.append((first, last, parse_control_types(words[1], line), words[2]))
+
+    return [pages[id] for id in sorted(pages)]
+
+
+def build_pool(names):
+    """
+    Lay the names out in one string, returning it as a list of pieces along with
+    each name's offset. Longest names go first so that shorter names which are
+    the tail of one of them can share its bytes.
+    """
+    pieces = []
+    offsets = {}
+    length = 0
+
+    for name in sorted(set(names), key=lambda name: (-len(name), name)):
+        for piece, start in pieces:
+            if piece.endswith(name):
+                offsets[name] = start + len(piece) - len(name)
+                break
+        else:
+            pieces.append((name, length))
+            offsets[name] = length
+            length += len(name.encode('utf-8')) + 1
+
+    return [piece for piece, _ in pieces], offsets
+
+
+def c_string(text):
+    return '"' + text.replace('\\', '\\\\').replace('"', '\\"') + '\\0"'
+
+
+def generate(pages):
+    names = list(FALLBACK_NAMES.values())
+    for page in pages:
+        names.append(page['name'])
+        names.extend(usage[3] for usage in page['usages'])
+
+    pieces, offsets = build_pool(names)
+
+    out = []
+    out.append('// Generated by scripts/gen_usage_tables.py from data/hid_usage_tables.txt, edit those instead.')
+    out.append('#pragma once')
+    out.append('')
+    out.append('#include "hid_descriptor.hxx"')
+    out.append('')
+    out.append('namespace HID {')
+    out.append('    namespace Descriptor {')
+    out.append('')
+    out.append('        // Every usage and page name, NUL terminated')
+    out.append('        inline constexpr char usage_strings[] =')
+    for piece in pieces:
+        out.append(f'            {c_string(piece)}')
+    out.append('            ;')
+    out.append('')
+    for constant, name in FALLBACK_NAMES.items():
+        out.append(f'        inline constexpr uint32_t {constant} = {offsets[name]};')
+    out.append('')
+
+    out.append('        // Ordered by page then usage')
+    out.append('        inline constexpr UsageDef usage_definitions[] = {')
+    first = 0
+    for page in pages:
+        page['first'] = first
+        for low, high, flags, name in page['usages']:
+            control_type = ' | '.join(flags) if flags else 'UCF_NONE'
+            out.append(f'            {{0x{page["id"]:02X}, 0x{low:02X}, 0x{high:02X}, {control_type}, {offsets[name]}}}, // {name.rstrip(chr(92))}')
+        first += len(page['usages'])
+    out.append('        };')
+    out.append('')
+
+    out.append('        // Ordered by page')
+    out.append('        inline constexpr UsagePageDef usage_pages[] = {')
+    for page in pages:
+        complete = 'true' if page['complete'] else 'false'
+        out.append(f'            {{0x{page["id"]:02X}, {complete}, {offsets[page["name"]]}, {page["first"]}, {len(page["usages"])}}}, // {page["name"]}')
+    out.append('        };')
+    out.append('    }')
+    out.append('}')
+
+    return '\n'.join(out) + '\n'
+
+
+def main(argv):
+    if len(argv) != 3:
+        print(__doc__.strip(), file=sys.stderr)
+        return 2
+
+    try:
+        pages = read_source(argv[1])
+    except SourceError as error:
+        print(f'{argv[1]}: {error}', file=sys.stderr)
+        return 1
+
+    with open(argv[2], 'w', encoding='utf-8', newline='\n') as header:
+        header.write(generate(pages))
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <bit>
+
+#include <stdint.h>
+#include <string.h>
+
+namespace HID {
+
+    /**
+     * Whether a field of `size` bits starting `offset` bits into `length` readable bytes
+     * can be read with `extract_bits_unchecked`: it is 1 to 32 bits, and a whole word
+     * starting at its first byte can be read.
+     *
+     * Callers reading many fields of one report can check the furthest of them once,
+     * and then read every field without checks.
+     */
+    inline bool fits_unchecked(size_t length, uint64_t offset, uint8_t size) {
+        return size - 1u < 32u && offset / 8 + sizeof(uint64_t) <= length;
+    }
+
+    /**
+     * Read a field of `size` bits (1 to 32) which starts `offset` bits into `data`,
+     * which the caller has already found `fits_unchecked`.
+     *
+     * Takes no branches, reading the one word which starts at the field's first byte.
+     */
+    inline int32_t extract_bits_unchecked(const unsigned char *data, uint32_t offset, uint8_t size, bool is_signed) {
+        uint64_t raw;
+
+        if constexpr (std::endian::native == std::endian::little) {
+            memcpy(&raw, data + offset / 8, sizeof(raw));
+        } else {
+            raw = 0;
+            for (size_t i = 0; i < sizeof(raw); i++) raw |= (uint64_t)data[offset / 8 + i] << (i * 8);
+        }
+
+        raw >>= offset % 8;
+
+        // Unsigned fields are masked, which leaves the shifts below to signed ones alone
+        if (!is_signed) return (int32_t)(uint32_t)(raw & ((1ull << size) - 1));
+
+        uint32_t shift = 32 - size;
+        return (int32_t)((uint32_t)raw << shift) >> shift;
+    }
+
+    /**
+     * Read a field of `size` bits (1 to 32) which starts `offset` bits into `data`.
+     *
+     * This is the one place report and descriptor data is pulled apart, so every
+     * reader agrees on it. Fields are little-endian and packed least significant bit
+     * first, as HID lays them out, and may start at any bit of any byte.
+     *
+     * Signed fields are sign extended from their top bit; unsigned 32-bit fields come
+     * back as their bit pattern, to be cast to `uint32_t`. Nothing past `length` bytes
+     * is read, and any bits of the field beyond it read as 0.
+     *
+     * Checks the field's bounds on every call; see `fits_unchecked` for reading many
+     * fields of one report with a single check.
+     */
+    inline int32_t extract_bits(const unsigned char *data, size_t length, uint32_t offset, uint8_t size, bool is_signed) {
+        if (fits_unchecked(length, offset, size)) return extract_bits_unchecked(data, offset, size, is_signed);
+
+        size_t byte = offset / 8;
+
+        if (size == 0 || byte >= length) return 0;
+        if (size > 32) size = 32;
+
+        // A field spans at most five bytes. Near the end of the buffer only the bytes
+        // which are left are copied, and the rest stay 0.
+        uint64_t raw = 0;
+
+        for (size_t i = 0; i < sizeof(raw) && byte + i < length; i++) raw |= (uint64_t)data[byte + i] << (i * 8);
+
+        uint32_t shift = 32 - size;
+        uint32_t value = (uint32_t)(raw >> (offset % 8)) << shift;
+
+        return is_signed ? (int32_t)value >> shift : (int32_t)(value >> shift);
+    }
+}
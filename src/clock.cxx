@@ -0,0 +1,51 @@
+#include "clock.hxx"
+
+#include <chrono>
+
+#if _WIN32
+    #include <windows.h>
+#elif __linux__
+    #include <time.h>
+#endif
+
+namespace HID {
+    namespace Clock {
+
+#if _WIN32
+
+        uint64_t now() {
+            static const uint64_t frequency = [] {
+                LARGE_INTEGER f;
+                QueryPerformanceFrequency(&f);
+                return (uint64_t)f.QuadPart;
+            }();
+
+            LARGE_INTEGER counter;
+            QueryPerformanceCounter(&counter);
+
+            // Split to avoid overflowing the multiplication on long uptimes
+            uint64_t ticks = (uint64_t)counter.QuadPart;
+            return (ticks / frequency) * 1000000000ull + (ticks % frequency) * 1000000000ull / frequency;
+        }
+
+#elif __linux__
+
+        uint64_t now() {
+            timespec ts;
+            clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+
+            return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+        }
+
+#else
+
+        uint64_t now() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()
+            ).count();
+        }
+
+#endif
+
+    }
+}
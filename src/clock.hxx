@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stdint.h>
+
+namespace HID {
+    namespace Clock {
+
+        /**
+         * Monotonic time in nanoseconds, for stamping reports.
+         *
+         * Uses the raw hardware clock where there is one (CLOCK_MONOTONIC_RAW on
+         * Linux, the performance counter on Windows), so stamps never jump with NTP
+         * or wall clock changes. Only differences between stamps are meaningful.
+         */
+        uint64_t now();
+
+    }
+}
@@ -0,0 +1,580 @@
+#include "descriptor_cache.hxx"
+
+#include <concepts>
+#include <type_traits>
+
+#include <stdio.h>
+#include <string.h>
+
+#if _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace HID {
+
+    namespace {
+
+        const char CACHE_MAGIC[4] = { 'F', 'F', 'B', 'D' };
+
+        typedef struct {
+            char magic[4];
+            uint32_t version;
+
+            // Guards against reading a file written by a build with a different `Node` layout
+            uint32_t node_size;
+
+            uint32_t count;
+        } FileHeader;
+
+        // Follows the header, once per entry
+        typedef struct {
+            uint16_t vendor_id;
+            uint16_t product_id;
+            uint32_t descriptor_length;
+            uint64_t hash;
+
+            // Hash of everything stored for the entry, to catch a damaged file
+            uint64_t checksum;
+
+            // Where the raw descriptor and the serialized `Descriptor` after it are, from the start of the file
+            uint64_t offset;
+            uint64_t length;
+        } EntryRecord;
+
+        /**
+         * Call `fn` on each member of a node, in the order they're stored.
+         *
+         * The stored structs are written member by member rather than whole, so the
+         * padding between members, which holds whatever was in memory before, never
+         * reaches the file or its checksum.
+         */
+        template <typename T, typename F> requires std::same_as<std::remove_const_t<T>, Descriptor::Node>
+        void members(T &node, F &&fn) {
+            fn(node.usage_page);
+            fn(node.report_id);
+            fn(node.usage_id);
+            fn(node.designator_index);
+            fn(node.string_index);
+            fn(node.delimiter);
+            fn(node.report_size);
+            fn(node.report_index);
+            fn(node.min_value);
+            fn(node.max_value);
+            fn(node.physical_min);
+            fn(node.physical_max);
+            fn(node.unit);
+            fn(node.unit_exp);
+            fn(node.collection);
+            fn(node.flags);
+        }
+
+        template <typename T, typename F> requires std::same_as<std::remove_const_t<T>, Descriptor::ReportLayout>
+        void members(T &layout, F &&fn) {
+            fn(layout.type);
+            fn(layout.report_id);
+            fn(layout.length);
+            fn(layout.first_field);
+            fn(layout.field_count);
+        }
+
+        template <typename T, typename F> requires std::same_as<std::remove_const_t<T>, Descriptor::Collection>
+        void members(T &collection, F &&fn) {
+            fn(collection.type);
+            fn(collection.usage_page);
+            fn(collection.usage);
+            fn(collection.parent);
+            fn(collection.first_field);
+            fn(collection.end_field);
+        }
+
+        template <typename T, typename F> requires std::same_as<std::remove_const_t<T>, Descriptor::ArrayField>
+        void members(T &array, F &&fn) {
+            fn(array.type);
+            fn(array.report_id);
+            fn(array.offset);
+            fn(array.size);
+            fn(array.count);
+            fn(array.logical_min);
+            fn(array.logical_max);
+            fn(array.usage_page);
+            fn(array.usage_min);
+            fn(array.usage_max);
+            fn(array.first_usage);
+            fn(array.usage_count);
+            fn(array.first_field);
+        }
+
+        /**
+         * Bytes one `T` takes up in the file.
+         */
+        template <typename T>
+        size_t record_size() {
+            size_t size = 0;
+            T record = {};
+
+            members(record, [&size](auto &member) { size += sizeof(member); });
+
+            return size;
+        }
+
+        /**
+         * Checksum of everything stored for an entry.
+         *
+         * FNV-1a taken a word at a time rather than a byte at a time, so checking an
+         * entry stays cheap next to reading it back. It only has to catch a damaged
+         * file, not spread the bits well enough to key on.
+         */
+        uint64_t entry_checksum(const unsigned char *data, size_t length) {
+            uint64_t hash = 0xcbf29ce484222325;
+            size_t i = 0;
+
+            for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+                uint64_t word;
+                memcpy(&word, data + i, sizeof(word));
+
+                hash ^= word;
+                hash *= 0x100000001b3;
+            }
+
+            for (; i < length; i++) {
+                hash ^= data[i];
+                hash *= 0x100000001b3;
+            }
+
+            return hash;
+        }
+
+        /**
+         * Appends values, vectors of them, and vectors of records (both prefixed with their length), to a buffer.
+         */
+        class Writer {
+            public:
+                Writer(std::vector<unsigned char> &out) : out(out) {}
+
+                template <typename T>
+                void value(const T &value) {
+                    bytes(&value, sizeof(T));
+                }
+
+                // Written as they are in memory, so only for types without padding
+                template <typename T>
+                void array(const std::vector<T> &values) {
+                    value((uint32_t)values.size());
+                    bytes(values.data(), values.size() * sizeof(T));
+                }
+
+                template <typename T>
+                void records(const std::vector<T> &values) {
+                    value((uint32_t)values.size());
+
+                    for (auto &record : values) {
+                        members(record, [this](auto &member) { value(member); });
+                    }
+                }
+
+                void bytes(const void *data, size_t length) {
+                    auto begin = (const unsigned char*)data;
+                    out.insert(out.end(), begin, begin + length);
+                }
+
+            private:
+                std::vector<unsigned char> &out;
+        };
+
+        /**
+         * Reads back what a `Writer` wrote, failing rather than reading past the end.
+         */
+        class Reader {
+            public:
+                Reader(const unsigned char *data, size_t length) : position(data), end(data + length) {}
+
+                template <typename T>
+                bool value(T &value) {
+                    if ((size_t)(end - position) < sizeof(T)) return false;
+
+                    memcpy(&value, position, sizeof(T));
+                    position += sizeof(T);
+
+                    return true;
+                }
+
+                template <typename T>
+                bool array(std::vector<T> &values) {
+                    uint32_t count;
+                    if (!value(count) || (size_t)(end - position) / sizeof(T) < count) return false;
+
+                    values.resize(count);
+                    if (count) memcpy(values.data(), position, count * sizeof(T));
+                    position += count * sizeof(T);
+
+                    return true;
+                }
+
+                template <typename T>
+                bool records(std::vector<T> &values) {
+                    uint32_t count;
+                    if (!value(count) || (size_t)(end - position) / record_size<T>() < count) return false;
+
+                    values.resize(count);
+
+                    // Every member fits, since the whole count was checked against what's left
+                    for (auto &record : values) {
+                        members(record, [this](auto &member) { value(member); });
+                    }
+
+                    return true;
+                }
+
+            private:
+                const unsigned char *position;
+                const unsigned char *end;
+        };
+
+        void write_fields(Writer &writer, const Descriptor::FieldTable &table) {
+            writer.value(table.type);
+            writer.array(table.report_ids);
+            writer.array(table.offsets);
+            writer.array(table.sizes);
+            writer.array(table.usage_pages);
+            writer.array(table.usages);
+            writer.array(table.logical_mins);
+            writer.array(table.logical_maxs);
+            writer.array(table.transforms);
+            writer.array(table.collections);
+        }
+
+        bool read_fields(Reader &reader, Descriptor::FieldTable &table) {
+            return reader.value(table.type)
+                && reader.array(table.report_ids)
+                && reader.array(table.offsets)
+                && reader.array(table.sizes)
+                && reader.array(table.usage_pages)
+                && reader.array(table.usages)
+                && reader.array(table.logical_mins)
+                && reader.array(table.logical_maxs)
+                && reader.array(table.transforms)
+                && reader.array(table.collections);
+        }
+
+        void write_descriptor(Writer &writer, const Descriptor::Descriptor &descriptor) {
+            writer.records(descriptor.inputs);
+            writer.records(descriptor.outputs);
+            writer.records(descriptor.features);
+
+            write_fields(writer, descriptor.input_fields);
+            write_fields(writer, descriptor.output_fields);
+            write_fields(writer, descriptor.feature_fields);
+
+            writer.records(descriptor.layouts);
+            writer.array(descriptor.layout_fields);
+
+            // Only the vertices are written; each one's parent is enough to put the edges back
+            std::vector<Descriptor::Collection> collections;
+
+            for (uint32_t i = 0; i < boost::num_vertices(descriptor.collections); i++) {
+                collections.push_back(descriptor.collections[i]);
+            }
+
+            writer.records(collections);
+
+            writer.records(descriptor.arrays);
+            writer.array(descriptor.array_usages);
+        }
+
+        bool read_descriptor(Reader &reader, Descriptor::Descriptor &descriptor) {
+            if (!reader.records(descriptor.inputs) || !reader.records(descriptor.outputs) || !reader.records(descriptor.features)) {
+                return false;
+            }
+
+            if (!read_fields(reader, descriptor.input_fields) || !read_fields(reader, descriptor.output_fields)
+                || !read_fields(reader, descriptor.feature_fields)) {
+                return false;
+            }
+
+            if (!reader.records(descriptor.layouts) || !reader.array(descriptor.layout_fields)) return false;
+
+            for (auto &layout : descriptor.layouts) {
+                if ((uint64_t)layout.first_field + layout.field_count > descriptor.layout_fields.size()) return false;
+            }
+
+            std::vector<Descriptor::Collection> collections;
+            if (!reader.records(collections)) return false;
+
+            // Parents always come before their children
+            for (uint32_t i = 0; i < collections.size(); i++) {
+                if (collections[i].parent != Descriptor::NO_COLLECTION && collections[i].parent >= i) return false;
+            }
+
+            descriptor.collections = Descriptor::collection_graph(collections);
+
+            return reader.records(descriptor.arrays) && reader.array(descriptor.array_usages);
+        }
+    }
+
+    uint64_t descriptor_hash(const unsigned char *data, size_t length) {
+        uint64_t hash = 0xcbf29ce484222325;
+
+        for (size_t i = 0; i < length; i++) {
+            hash ^= data[i];
+            hash *= 0x100000001b3;
+        }
+
+        return hash;
+    }
+
+    DescriptorCache::~DescriptorCache() {
+        unmap();
+    }
+
+    void DescriptorCache::open(const std::string &path) {
+        unmap();
+
+        this->path = path;
+        entries.clear();
+        added.clear();
+        dirty = false;
+
+        if (!map()) {
+            unmap();
+            return;
+        }
+
+        FileHeader header;
+
+        if (mapping_length < sizeof(header)) {
+            unmap();
+            return;
+        }
+
+        memcpy(&header, mapping, sizeof(header));
+
+        bool current = memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0
+            && header.version == DESCRIPTOR_CACHE_VERSION
+            && header.node_size == sizeof(Descriptor::Node)
+            && header.count <= (mapping_length - sizeof(header)) / sizeof(EntryRecord);
+
+        if (!current) {
+            unmap();
+            return;
+        }
+
+        for (uint32_t i = 0; i < header.count; i++) {
+            EntryRecord record;
+            memcpy(&record, mapping + sizeof(header) + i * sizeof(EntryRecord), sizeof(record));
+
+            if (record.offset > mapping_length || record.length > mapping_length - record.offset || record.descriptor_length > record.length) {
+                entries.clear();
+                unmap();
+                return;
+            }
+
+            entries.push_back({
+                .vendor_id = record.vendor_id,
+                .product_id = record.product_id,
+                .hash = record.hash,
+                .checksum = record.checksum,
+                .data = mapping + record.offset,
+                .descriptor_length = record.descriptor_length,
+                .length = (size_t)record.length,
+            });
+        }
+    }
+
+    std::shared_ptr<const Descriptor::Descriptor> DescriptorCache::find(uint16_t vendor_id, uint16_t product_id, const unsigned char *data, size_t length) {
+        uint64_t hash = descriptor_hash(data, length);
+
+        for (auto &entry : entries) {
+            if (entry.hash != hash || entry.vendor_id != vendor_id || entry.product_id != product_id) continue;
+            if (entry.descriptor_length != length || memcmp(entry.data, data, length) != 0) continue;
+
+            if (entry.loaded) return entry.loaded;
+
+            // A damaged entry is treated as missing, and the device parsed as usual
+            if (entry_checksum(entry.data, entry.length) != entry.checksum) return nullptr;
+
+            auto descriptor = std::make_shared<Descriptor::Descriptor>();
+            Reader reader(entry.data + length, entry.length - length);
+
+            if (!read_descriptor(reader, *descriptor)) return nullptr;
+
+            entry.loaded = descriptor;
+            return descriptor;
+        }
+
+        return nullptr;
+    }
+
+    void DescriptorCache::add(uint16_t vendor_id, uint16_t product_id, const unsigned char *data, size_t length, const Descriptor::Descriptor &descriptor) {
+        if (path.empty()) return;
+
+        std::vector<unsigned char> buffer;
+        Writer writer(buffer);
+
+        writer.bytes(data, length);
+        write_descriptor(writer, descriptor);
+
+        added.push_back(std::make_unique<unsigned char[]>(buffer.size()));
+        memcpy(added.back().get(), buffer.data(), buffer.size());
+
+        entries.push_back({
+            .vendor_id = vendor_id,
+            .product_id = product_id,
+            .hash = descriptor_hash(data, length),
+            .checksum = entry_checksum(buffer.data(), buffer.size()),
+            .data = added.back().get(),
+            .descriptor_length = length,
+            .length = buffer.size(),
+        });
+
+        dirty = true;
+    }
+
+    bool DescriptorCache::save() {
+        if (!dirty || path.empty()) return true;
+
+        // Everything is copied out first, since the mapped file is about to be replaced.
+        std::vector<unsigned char> file;
+        Writer writer(file);
+
+        FileHeader header = {};
+        memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+        header.version = DESCRIPTOR_CACHE_VERSION;
+        header.node_size = sizeof(Descriptor::Node);
+        header.count = (uint32_t)entries.size();
+        writer.value(header);
+
+        uint64_t offset = sizeof(header) + entries.size() * sizeof(EntryRecord);
+
+        for (auto &entry : entries) {
+            EntryRecord record = {
+                .vendor_id = entry.vendor_id,
+                .product_id = entry.product_id,
+                .descriptor_length = (uint32_t)entry.descriptor_length,
+                .hash = entry.hash,
+                .checksum = entry.checksum,
+                .offset = offset,
+                .length = entry.length,
+            };
+
+            writer.value(record);
+            offset += entry.length;
+        }
+
+        for (auto &entry : entries) {
+            writer.bytes(entry.data, entry.length);
+        }
+
+        // Written to the side and renamed into place, so a crash can't leave a half-written cache
+        std::string temporary = path + ".tmp";
+        FILE *out = fopen(temporary.c_str(), "wb");
+        if (!out) return false;
+
+        bool written = fwrite(file.data(), 1, file.size(), out) == file.size();
+        written = fclose(out) == 0 && written;
+
+        if (!written) {
+            remove(temporary.c_str());
+            return false;
+        }
+
+        // Entries still read from the mapped file are copied out before it's replaced
+        for (auto &entry : entries) {
+            if (entry.data < mapping || entry.data >= mapping + mapping_length) continue;
+
+            added.push_back(std::make_unique<unsigned char[]>(entry.length));
+            memcpy(added.back().get(), entry.data, entry.length);
+
+            entry.data = added.back().get();
+        }
+
+        unmap();
+
+#if _WIN32
+        bool renamed = MoveFileExA(temporary.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+        bool renamed = rename(temporary.c_str(), path.c_str()) == 0;
+#endif
+
+        // The entries are all still held in memory, so they're kept for the next `save` to try again
+        if (!renamed) {
+            remove(temporary.c_str());
+            return false;
+        }
+
+        // Pick the entries up again from the new file, so the copies can go
+        open(path);
+
+        return true;
+    }
+
+#if _WIN32
+
+    bool DescriptorCache::map() {
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+            CloseHandle(file);
+            return false;
+        }
+
+        HANDLE section = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+
+        if (section == nullptr) return false;
+
+        // The view keeps the section alive on its own
+        mapping = (const unsigned char*)MapViewOfFile(section, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(section);
+
+        if (mapping == nullptr) return false;
+
+        mapping_length = (size_t)size.QuadPart;
+        return true;
+    }
+
+    void DescriptorCache::unmap() {
+        if (mapping) UnmapViewOfFile(mapping);
+
+        mapping = nullptr;
+        mapping_length = 0;
+    }
+
+#else
+
+    bool DescriptorCache::map() {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+
+        struct stat status;
+        if (fstat(fd, &status) != 0 || status.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+
+        void *view = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+
+        if (view == MAP_FAILED) return false;
+
+        mapping = (const unsigned char*)view;
+        mapping_length = (size_t)status.st_size;
+        return true;
+    }
+
+    void DescriptorCache::unmap() {
+        if (mapping) munmap((void*)mapping, mapping_length);
+
+        mapping = nullptr;
+        mapping_length = 0;
+    }
+
+#endif
+
+}
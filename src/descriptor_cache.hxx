@@ -0,0 +1,110 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+#include "hid_descriptor.hxx"
+
+namespace HID {
+
+    /**
+     * Version of the cache file format.
+     *
+     * Bump it whenever the file layout, or anything stored for a descriptor (the
+     * node, field table, layout, collection and array types), changes, or when
+     * the parser starts reading the same descriptor differently. Files written by
+     * any other version are ignored and replaced.
+     */
+    const uint32_t DESCRIPTOR_CACHE_VERSION = 10;
+
+    /**
+     * 64-bit FNV-1a hash of a report descriptor's bytes.
+     */
+    uint64_t descriptor_hash(const unsigned char *data, size_t length);
+
+    /**
+     * Parsed report descriptors kept on disk, so devices which have been seen
+     * before don't need to be parsed again.
+     *
+     * Entries are keyed by vendor ID, product ID and the hash of the raw descriptor,
+     * and also hold the raw bytes so that a hash collision can't return the wrong
+     * descriptor. A device whose descriptor changes (after a firmware update, say)
+     * is simply parsed again and gets an entry of its own.
+     *
+     * The file is mapped into memory when opened. A descriptor is only checked and
+     * copied out of it the first time a device asks for it, and shared from then on.
+     *
+     * Not thread safe.
+     */
+    class DescriptorCache {
+        public:
+            DescriptorCache() = default;
+            DescriptorCache(const DescriptorCache&) = delete;
+            DescriptorCache& operator=(const DescriptorCache&) = delete;
+
+            ~DescriptorCache();
+
+            /**
+             * Map the cache file at `path`.
+             *
+             * A missing, damaged or outdated file leaves the cache empty, and is
+             * replaced by the next `save`. Until this is called the cache is disabled.
+             */
+            void open(const std::string &path);
+
+            /**
+             * Get the descriptor stored for these exact descriptor bytes, or null if there isn't one.
+             */
+            std::shared_ptr<const Descriptor::Descriptor> find(uint16_t vendor_id, uint16_t product_id, const unsigned char *data, size_t length);
+
+            /**
+             * Add a descriptor which was parsed from `data`. It's written out by the next `save`.
+             */
+            void add(uint16_t vendor_id, uint16_t product_id, const unsigned char *data, size_t length, const Descriptor::Descriptor &descriptor);
+
+            /**
+             * Rewrite the cache file if anything was added since it was opened or last saved.
+             *
+             * Returns false if the file couldn't be written, keeping everything
+             * added so the next call can try again.
+             */
+            bool save();
+
+        private:
+            typedef struct {
+                uint16_t vendor_id;
+                uint16_t product_id;
+                uint64_t hash;
+                uint64_t checksum;
+
+                // The raw descriptor followed by the serialized `Descriptor`
+                const unsigned char *data;
+                size_t descriptor_length;
+                size_t length;
+
+                // The descriptor read back from `data`, once `find` has been asked for it
+                std::shared_ptr<const Descriptor::Descriptor> loaded;
+            } Entry;
+
+            std::string path;
+
+            // The mapped file, or null
+            const unsigned char *mapping = nullptr;
+            size_t mapping_length = 0;
+
+            // Entries in the mapped file, followed by any added since
+            std::vector<Entry> entries;
+
+            // Storage for the entries added since the file was mapped
+            std::vector<std::unique_ptr<unsigned char[]>> added;
+
+            bool dirty = false;
+
+            bool map();
+            void unmap();
+    };
+
+}
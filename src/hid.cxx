@@ -1,7 +1,10 @@
 #include "hid.hxx"
+#include "clock.hxx"
+#include "poller.hxx"
 
 #include <algorithm>
 #include <map>
+#include <math.h>
 #include <thread>
 
 #include <assert.h>
@@ -33,17 +36,98 @@ const auto processor_count = std::thread::hardware_concurrency();
 
 namespace HID {
 
+    /**
+     * Read one report from the device and push it onto its ring.
+     *
+     * Nothing is pushed if no report was pending. Returns the result of the read.
+     * `arrival` is the earliest time the report is known to have been available,
+     * and `queued` is set when that isn't when it arrived (see `DeviceBuffer::queued`).
+     */
+    static int read_report(DeviceInfo *device, uint64_t arrival, bool queued) {
+        unsigned char buffer[BUFFER_SIZE];
+        int length;
+
+        if (device->fd >= 0) {
+            length = Poller::read(device->fd, buffer, sizeof(buffer));
+        } else {
+            length = hid_read(device->device, buffer, sizeof(buffer));
+        }
+
+        if (length < 0) {
+            // Unplugged devices fail every read from here on.
+            device->disconnected.store(true, std::memory_order_relaxed);
+        }
+
+        if (length < 1) return length;
+
+        uint8_t report_id = device->numbered ? buffer[0] : 0;
+        if (!device->reports[report_id].ring) report_id = 0;
+
+        ReportHistory &history = device->reports[report_id];
+
+        // The report being replaced is only lost if no consumer has seen it yet.
+        uint64_t written = history.ring->head();
+        if (written - history.observed.load(std::memory_order_relaxed) >= history.ring->capacity()) {
+            device->counters.ring_overwrites.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // Only the gap between two reports whose arrivals were both seen is the device's own interval
+        if (!queued && device->last_arrival != 0) device->intervals.record(arrival - device->last_arrival);
+        device->last_arrival = queued ? 0 : arrival;
+
+        uint64_t done = Clock::now();
+        history.ring->push(buffer, length, arrival, (uint32_t)std::min<uint64_t>(done - arrival, UINT32_MAX), queued);
+        device->last_report_id.store(report_id, std::memory_order_release);
+        device->counters.reports_read.fetch_add(1, std::memory_order_relaxed);
+
+        return length;
+    }
+
+    size_t drain_reports(DeviceInfo *device, bool polled, uint64_t wake) {
+        size_t count = 0;
+
+        // Bounded so a device reporting faster than we can read can't starve the others
+        // A polling tick says nothing about when its first report arrived, and a report behind another
+        // was already waiting, so only the first report of an event wake has its real arrival time
+        while (count < NUM_BUFFERS && read_report(device, count == 0 ? wake : Clock::now(), polled || count > 0) > 0) count++;
+
+        // Draining a whole queue's worth doesn't prove anything was dropped, only that it could have been
+        if (count >= OS_QUEUE_DEPTH) {
+            device->counters.queue_possibly_full.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if (count == 0 && polled && !device->disconnected.load(std::memory_order_relaxed)) {
+            // If the read timed out, repeat the previous report
+            device->reports[device->last_report_id.load(std::memory_order_relaxed)].ring->repeat(wake);
+        }
+
+        return count;
+    }
+
+    DeviceManager GlobalDeviceManager;
+
     DeviceManager::~DeviceManager() {
-        if (this->devices != nullptr) {
-            hid_free_enumeration(this->devices);
-            this->devices = nullptr;
-            this->initialized = false;
-
-            for (auto dev : this->handles) {
-                hid_close(dev.second->device);
-                free(dev.second);
-            }
+        this->hotplug.stop();
+        this->scheduler.stop();
+
+        // hidapi can't be shut down under a thread which is still stuck opening a device
+        bool idle = this->opener.stop();
+
+        for (auto dev : this->handles) {
+            close(dev.second);
         }
+
+        this->handles.clear();
+
+        while (this->devices != nullptr) {
+            hid_device_info *next = this->devices->next;
+            free_device_info(this->devices);
+            this->devices = next;
+        }
+
+        if (this->initialized && idle) hid_exit();
+
+        this->initialized = false;
     }
 
     const hid_device_info * DeviceManager::get_devices() {
@@ -56,75 +140,551 @@ namespace HID {
 
     void DeviceManager::init() {
         hid_init();
-        //devices = hid_enumerate(0x16d0, 0x0d60);
-        devices = hid_enumerate(0x00, 0x00);
 
-        auto i = 0;
-        std::vector<std::vector<DeviceInfo*>> device_map(processor_count);
-        
-        for (auto device = devices; device; device = device->next) {
-            hid_device *handle = hid_open_path(device->path);
-            DeviceInfo *dev = (DeviceInfo*)malloc(sizeof(DeviceInfo));
+        size_t workers = reader_threads ? reader_threads : std::min<size_t>(std::max(processor_count, 1u), DEFAULT_MAX_READERS);
+        scheduler.start(workers, capture_mode);
 
-            hid_set_nonblocking(handle, 1);
-            dev->device = handle;
-            dev->current_buffer = 0;
-            dev->report_descriptor.length = hid_get_report_descriptor(handle, dev->report_descriptor.data, sizeof(dev->report_descriptor.data));
+        std::unique_lock<std::shared_timed_mutex> enumerating(enumeration_lock);
+        //hid_device_info *enumeration = hid_enumerate(0x16d0, 0x0d60);
+        hid_device_info *enumeration = hid_enumerate(0x00, 0x00);
+        enumerating.unlock();
+        hid_device_info **tail = &devices;
+        std::vector<std::string> known;
 
-            auto descriptor = Descriptor::parse(dev->report_descriptor.data, dev->report_descriptor.length);
+        device_count = 0;
 
-            // Find the total number of reports, and how big they need to be
+        std::vector<DeviceInfo*> eager;
 
+        for (auto device = enumeration; device; device = device->next) {
+            *tail = copy_device_info(device);
+            tail = &(*tail)->next;
+
+            DeviceInfo *dev = track(device);
+            if (in_profile(device)) eager.push_back(dev);
 
             handles.emplace(device->path, dev);
+            known.push_back(device->path);
+            device_count++;
+        }
+
+        hid_free_enumeration(enumeration);
+
+        describe(eager);
+        for (auto dev : eager) capture(dev);
+
+        hotplug.start(known);
+
+        initialized = true;
+    }
+
+    bool DeviceManager::update() {
+        if (!initialized) {
+            return false;
+        }
+
+        take_opened();
+
+        DeviceChanges changes;
+
+        // Devices which failed a read are probably gone, so check now rather than waiting for a uevent,
+        // but no more often than the monitor would re-enumerate anyway.
+        auto now = std::chrono::steady_clock::now();
+
+        if (now - last_rescan >= HOTPLUG_INTERVAL) {
+            bool requested = false;
+
+            for (auto &[_, dev] : handles) {
+                if (!dev->disconnected.load(std::memory_order_relaxed)) continue;
 
-            dev->buffers = (DeviceBuffer*)calloc(NUM_BUFFERS, sizeof(DeviceBuffer));
-            memset(dev->buffers, 0, NUM_BUFFERS * sizeof(DeviceBuffer));
+                // Still listed a whole rescan after it failed, so it wasn't unplugged after all
+                if (dev->rescanned) {
+                    reopen(dev);
+                    continue;
+                }
+
+                dev->rescanned = true;
+                requested = true;
+            }
 
-            device_map.at(i % processor_count).push_back(dev);
+            if (requested) {
+                hotplug.rescan();
+                last_rescan = now;
+            }
         }
 
-        for (auto group : device_map) {
-            readers.emplace_back(std::thread(&DeviceManager::readLoop, this, group));
+        if (!hotplug.take_changes(changes)) {
+            return false;
         }
 
-        initialized = true;
+        for (auto &path : changes.removed) {
+            auto it = handles.find(path);
+
+            if (it != handles.end()) {
+                close(it->second);
+                handles.erase(it);
+            }
+
+            for (hid_device_info **node = &devices; *node; node = &(*node)->next) {
+                if (path == (*node)->path) {
+                    hid_device_info *removed = *node;
+                    *node = removed->next;
+                    free_device_info(removed);
+                    device_count--;
+                    break;
+                }
+            }
+        }
+
+        hid_device_info **tail = &devices;
+        while (*tail) tail = &(*tail)->next;
+
+        std::vector<DeviceInfo*> eager;
+
+        for (auto device : changes.added) {
+            // A device which was replaced under the same path is closed above and reopened here.
+            auto it = handles.find(std::string_view(device->path));
+
+            if (it != handles.end()) {
+                free_device_info(device);
+                continue;
+            }
+
+            DeviceInfo *dev = track(device);
+            if (in_profile(device)) eager.push_back(dev);
+
+            handles.emplace(device->path, dev);
+
+            *tail = device;
+            tail = &device->next;
+            device_count++;
+        }
+
+        describe(eager);
+        for (auto dev : eager) capture(dev);
+
+        return true;
+    }
+
+    DeviceInfo* DeviceManager::track(const hid_device_info *device) {
+        DeviceInfo *dev = new DeviceInfo{};
+
+        dev->path = device->path;
+        dev->state = DeviceState::Enumerated;
+        dev->vendor_id = device->vendor_id;
+        dev->product_id = device->product_id;
+        dev->fd = -1;
+        dev->worker = -1;
+
+        static const auto undescribed = std::make_shared<const Descriptor::Descriptor>();
+        dev->descriptor = undescribed;
+
+        return dev;
+    }
+
+    bool DeviceManager::in_profile(const hid_device_info *device) {
+        return profile.contains((uint32_t)device->vendor_id << 16 | device->product_id);
+    }
+
+    bool DeviceManager::describe(DeviceInfo *dev) {
+        describe(std::vector<DeviceInfo*>{dev});
+
+        return dev->state == DeviceState::Described || dev->state == DeviceState::Capturing;
+    }
+
+    void DeviceManager::describe(const std::vector<DeviceInfo*> &devices) {
+        std::vector<DeviceInfo*> pending;
+        std::vector<std::string> paths;
+
+        for (auto dev : devices) {
+            if (dev->state != DeviceState::Enumerated) continue;
+
+            pending.push_back(dev);
+            paths.push_back(dev->path);
+        }
+
+        if (pending.empty()) {
+            return;
+        }
+
+        auto results = opener.open(paths);
+
+        for (size_t i = 0; i < pending.size(); i++) {
+            describe(pending[i], results[i]);
+        }
+
+        // A cache which can't be written only costs parsing these devices again next time
+        descriptor_cache.save();
+    }
+
+    void DeviceManager::describe(DeviceInfo *dev, const OpenResult &result) {
+        dev->open_ns = result.open_ns;
+        dev->describe_ns = result.describe_ns;
+
+        // Devices we can't open (no permission, already gone again, or hung) stay listed without being captured.
+        switch (result.status) {
+            case OpenStatus::Failed:
+                dev->state = DeviceState::Failed;
+                return;
+            case OpenStatus::TimedOut:
+                dev->state = DeviceState::TimedOut;
+                return;
+            case OpenStatus::Opened:
+                break;
+        }
+
+        dev->device = result.device;
+        dev->report_descriptor.length = result.descriptor_length;
+        memcpy(dev->report_descriptor.data, result.descriptor, result.descriptor_length);
+
+        uint64_t start = Clock::now();
+        auto &descriptor = dev->report_descriptor;
+
+        // Read straight off the raw bytes, so these hold whether or not the descriptor is cached
+        dev->application_usage = Descriptor::application_usage(descriptor.data, descriptor.length);
+        dev->force_feedback = Descriptor::is_pid_device(descriptor.data, descriptor.length);
+
+        auto cached = descriptor_cache.find(dev->vendor_id, dev->product_id, descriptor.data, descriptor.length);
+        dev->cached = cached != nullptr;
+
+        if (cached) {
+            dev->descriptor = std::move(cached);
+        } else {
+            auto parsed = std::make_shared<const Descriptor::Descriptor>(Descriptor::parse(descriptor.data, descriptor.length));
+            descriptor_cache.add(dev->vendor_id, dev->product_id, descriptor.data, descriptor.length, *parsed);
+            dev->descriptor = std::move(parsed);
+        }
+
+        dev->parse_ns = Clock::now() - start;
+        dev->state = DeviceState::Described;
+    }
+
+    void DeviceManager::open_async(DeviceInfo *dev) {
+        if (dev->state != DeviceState::Enumerated) return;
+
+        dev->state = DeviceState::Opening;
+        opening.emplace(opener.open_async(dev->path), dev);
+    }
+
+    void DeviceManager::take_opened() {
+        std::vector<std::pair<uint64_t, OpenResult>> results;
+
+        if (!opener.take_results(results)) return;
+
+        for (auto &[id, result] : results) {
+            auto it = opening.find(id);
+
+            // The device was removed while it was being opened
+            if (it == opening.end()) {
+                if (result.device) hid_close(result.device);
+                continue;
+            }
+
+            DeviceInfo *dev = it->second;
+            opening.erase(it);
+
+            describe(dev, result);
+
+            if (dev->capture_when_open) {
+                dev->capture_when_open = false;
+                capture(dev);
+            }
+        }
+
+        descriptor_cache.save();
+    }
+
+    bool DeviceManager::capture(DeviceInfo *dev) {
+        if (dev->state == DeviceState::Capturing) {
+            return true;
+        }
+
+        if (!describe(dev)) {
+            return false;
+        }
+
+        // Give each input report its own ring, sized for that report
+        auto lengths = dev->descriptor->report_lengths(Descriptor::MainItemTag::INPUT);
+        dev->numbered = !lengths.empty() && lengths.begin()->first != 0;
+
+        size_t budget = RING_BYTES;
+
+        if (dev->numbered) {
+            // Reports with undeclared IDs go to ring 0. They're not meant to turn up at all, so
+            // it keeps just a few, and none of them can be longer than the longest declared one.
+            dev->reports[0].ring = std::make_unique<ReportRing>(STRAY_REPORTS, dev->descriptor->max_report_length(Descriptor::MainItemTag::INPUT));
+            budget -= std::min(budget, dev->reports[0].ring->memory_usage());
+        } else if (lengths.empty()) {
+            // Every report goes to ring 0 if the descriptor doesn't say how long they are
+            lengths[0] = BUFFER_SIZE;
+        }
+
+        for (auto [report_id, report_length] : lengths) {
+            if (report_id >= MAX_REPORT_IDS) continue;
+
+            dev->reports[report_id].ring = std::make_unique<ReportRing>(
+                std::max(MIN_RING_REPORTS, ReportRing::capacity_for(budget / lengths.size(), report_length)),
+                report_length
+            );
+        }
+
+        dev->fd = capture_mode == CaptureMode::Event ? Poller::open(dev->path.c_str()) : -1;
+        dev->state = DeviceState::Capturing;
+
+        scheduler.add(dev);
+
+        return true;
+    }
+
+    void DeviceManager::close(DeviceInfo *dev) {
+        // Once the scheduler lets go of the device, no worker is reading it.
+        if (dev->worker.load() >= 0) scheduler.remove(dev);
+
+        std::erase_if(opening, [dev](auto &entry) { return entry.second == dev; });
+
+        Poller::close(dev->fd);
+        if (dev->device) hid_close(dev->device);
+
+        delete dev;
+    }
+
+    void DeviceManager::reopen(DeviceInfo *dev) {
+        bool capturing = dev->state == DeviceState::Capturing;
+
+        if (dev->worker.load() >= 0) scheduler.remove(dev);
+
+        Poller::close(dev->fd);
+        dev->fd = -1;
+
+        if (dev->device) hid_close(dev->device);
+        dev->device = nullptr;
+
+        // Capture starts over with new rings, so nothing about the old ones may carry over: a stale
+        // `observed` would count every report into the new ring as an overwrite, and the gap while
+        // the device was gone would be recorded as an interval
+        for (auto &history : dev->reports) {
+            history.ring.reset();
+            history.observed.store(0, std::memory_order_relaxed);
+        }
+
+        dev->last_report_id.store(0, std::memory_order_relaxed);
+        dev->last_arrival = 0;
+
+        dev->disconnected.store(false, std::memory_order_relaxed);
+        dev->rescanned = false;
+        dev->state = DeviceState::Enumerated;
+
+        // Opened again in the background, since this runs on the UI thread
+        if (capturing) {
+            dev->capture_when_open = true;
+            open_async(dev);
+        }
+    }
+
+    DeviceInfo* DeviceManager::find(const hid_device_info *device) {
+        auto it = handles.find(std::string_view(device->path));
+        return it == handles.end() ? nullptr : it->second;
     }
 
     hid_device* DeviceManager::open_device(const hid_device_info *device) {
-        std::map<char*, DeviceInfo*>::iterator it = handles.find(device->path);
-        return it->second->device;
+        DeviceInfo *dev = find(device);
+        return dev && describe(dev) ? dev->device : nullptr;
+    }
+
+    const DeviceInfo* DeviceManager::describe(const hid_device_info *device) {
+        DeviceInfo *dev = find(device);
+        if (dev) describe(dev);
+
+        return dev;
+    }
+
+    const DeviceInfo* DeviceManager::request_describe(const hid_device_info *device) {
+        DeviceInfo *dev = find(device);
+        if (dev) open_async(dev);
+
+        return dev;
+    }
+
+    const DeviceInfo* DeviceManager::request_capture(const hid_device_info *device) {
+        DeviceInfo *dev = find(device);
+        if (!dev) return nullptr;
+
+        if (dev->state == DeviceState::Enumerated || dev->state == DeviceState::Opening) {
+            dev->capture_when_open = true;
+            open_async(dev);
+        } else {
+            capture(dev);
+        }
+
+        return dev;
+    }
+
+    const DeviceInfo* DeviceManager::capture(const hid_device_info *device) {
+        DeviceInfo *dev = find(device);
+        if (dev) capture(dev);
+
+        return dev;
+    }
+
+    void DeviceManager::describe_all() {
+        std::vector<DeviceInfo*> all;
+
+        for (auto &[_, dev] : handles) {
+            all.push_back(dev);
+        }
+
+        describe(all);
+    }
+
+    void DeviceManager::add_profile_device(uint16_t vendor_id, uint16_t product_id) {
+        profile.insert((uint32_t)vendor_id << 16 | product_id);
+    }
+
+    void DeviceManager::set_descriptor_cache(const std::string &path) {
+        descriptor_cache.open(path);
+    }
+
+    DeviceBuffer DeviceManager::get_latest_report(const hid_device_info *device) {
+        auto it = handles.find(std::string_view(device->path));
+        DeviceBuffer report = {};
+        report.length = -1;
+
+        if (it != handles.end()) {
+            auto &history = it->second->reports[it->second->last_report_id.load(std::memory_order_acquire)];
+            if (history.ring) history.ring->latest(report);
+        }
+
+        return report;
+    }
+
+    DeviceBuffer DeviceManager::get_latest_report(const hid_device_info *device, uint8_t report_id) {
+        auto it = handles.find(std::string_view(device->path));
+        DeviceBuffer report = {};
+        report.length = -1;
+
+        if (it != handles.end()) {
+            auto &history = it->second->reports[report_id];
+            if (history.ring) history.ring->latest(report);
+        }
+
+        return report;
     }
 
-    const DeviceBuffer* DeviceManager::get_latest_report(const hid_device_info *device) {
-        std::map<char*, DeviceInfo*>::iterator it = handles.find(device->path);
-        return &(it->second->buffers[it->second->current_buffer]);
+    UpdateRate DeviceManager::get_update_rate(const hid_device_info *device) {
+        auto it = handles.find(std::string_view(device->path));
+        UpdateRate rate = {};
+
+        if (it == handles.end()) {
+            return rate;
+        }
+
+        // Arrival times, and whether each is when the report arrived rather than when it was read
+        std::vector<std::pair<uint64_t, bool>> arrivals;
+        double latency = 0;
+
+        for (auto &history : it->second->reports) {
+            if (!history.ring) continue;
+
+            auto ring = history.ring.get();
+            uint64_t head = ring->head();
+
+            ring->for_each(head > ring->capacity() ? head - ring->capacity() : 0, head, [&](uint64_t, const DeviceBuffer &report) {
+                if (report.repeated) return;
+
+                arrivals.emplace_back(report.arrival, !report.queued);
+                latency += report.latency;
+            });
+        }
+
+        if (arrivals.size() < 2) {
+            return rate;
+        }
+
+        // Histories of different report IDs are each in order, but interleave with each other.
+        std::sort(arrivals.begin(), arrivals.end());
+
+        // Counting reports over the span holds however they were read
+        uint64_t span = arrivals.back().first - arrivals.front().first;
+        rate.rate = span > 0 ? (arrivals.size() - 1) * 1e9 / span : 0;
+        rate.mean_latency = latency / arrivals.size();
+
+        double sum = 0, sum_sq = 0;
+
+        for (size_t i = 1; i < arrivals.size(); i++) {
+            if (!arrivals[i].second || !arrivals[i - 1].second) continue;
+
+            uint64_t interval = arrivals[i].first - arrivals[i - 1].first;
+
+            rate.min_interval = rate.samples ? std::min(rate.min_interval, interval) : interval;
+            rate.max_interval = std::max(rate.max_interval, interval);
+            sum += (double)interval;
+            sum_sq += (double)interval * (double)interval;
+            rate.samples++;
+        }
+
+        if (rate.samples == 0) return rate;
+
+        rate.mean_interval = sum / rate.samples;
+        rate.stddev_interval = sqrt(std::max(0.0, sum_sq / rate.samples - rate.mean_interval * rate.mean_interval));
+
+        return rate;
     }
 
-    void DeviceManager::get_update_rate(const hid_device_info *device) {
-        std::map<char*, DeviceInfo*>::iterator it = handles.find(device->path);
-        std::chrono::time_point<std::chrono::system_clock> oldest, newest;
-        auto buffers = it->second->buffers;
+    IntervalStats DeviceManager::get_interval_stats(const hid_device_info *device) {
+        auto it = handles.find(std::string_view(device->path));
 
-        oldest = newest = buffers[0].lru;
+        if (it == handles.end()) {
+            return {};
+        }
 
-        for (auto i = 1; i < NUM_BUFFERS; i++) {
-            auto lru = buffers[i].lru;
+        return it->second->intervals.summary();
+    }
 
-            oldest = lru < oldest ? lru : oldest;
-            newest = lru > newest ? lru : newest;
-        } 
+    void DeviceManager::reset_interval_stats(const hid_device_info *device) {
+        auto it = handles.find(std::string_view(device->path));
 
-        auto d = newest - oldest;
+        if (it != handles.end()) {
+            it->second->intervals.reset();
+        }
+    }
+
+    DeviceCounters DeviceManager::get_counters(const hid_device_info *device) {
+        auto it = handles.find(std::string_view(device->path));
+
+        if (it == handles.end()) {
+            return {};
+        }
+
+        auto &counters = it->second->counters;
+
+        return {
+            .reports_read = counters.reports_read.load(std::memory_order_relaxed),
+            .queue_possibly_full = counters.queue_possibly_full.load(std::memory_order_relaxed),
+            .ring_overwrites = counters.ring_overwrites.load(std::memory_order_relaxed),
+        };
+    }
+
+    void DeviceManager::set_capture_mode(CaptureMode mode) {
+        capture_mode = mode;
+    }
+
+    CaptureMode DeviceManager::get_capture_mode() {
+        return capture_mode;
+    }
+
+    void DeviceManager::set_reader_threads(size_t count) {
+        reader_threads = count;
+    }
+
+    Scheduler& DeviceManager::get_scheduler() {
+        return scheduler;
     }
 
     const DeviceInfo* DeviceManager::get_device(const hid_device_info *device) {
-        std::map<char*, DeviceInfo*>::iterator it = handles.find(device->path);
-        return it->second;
+        return find(device);
     }
 
-    float* DeviceManager::get_input_series(const hid_device_info *device, const Descriptor::Node *input) {
-       std::map<char*, DeviceInfo*>::iterator it = handles.find(device->path);
+    float* DeviceManager::get_input_series(const hid_device_info *device, Descriptor::FieldHandle input, bool physical) {
+       auto it = handles.find(std::string_view(device->path));
 
         if (it == handles.end()) {
             return {};
@@ -135,75 +695,53 @@ namespace HID {
         float *values = (float*)malloc(NUM_BUFFERS * sizeof(float));
         memset(values, 0, NUM_BUFFERS * sizeof(float));
 
-        // Input sizes and indices are given as bits rather than bytes.
-        size_t value_slot = input->report_index / 8;
-        uint8_t bit_offset = input->report_index % 8;
+        const Descriptor::FieldTable &fields = dev->descriptor->fields(input);
+        if (input.row() >= fields.size()) return values;
 
-        size_t value_sz = 1; 
-        
-        if (input->report_size >= 8) {
-            value_sz = input->report_size / 8;
-        }
+        uint8_t report_id = fields.report_ids[input.row()];
+        uint32_t report_index = fields.offsets[input.row()];
+        uint8_t report_size = fields.sizes[input.row()];
 
-        // If the report ID isn't zero, then the value is one byte further along...
-        if (input->report_id != 0) ++value_slot;
+        // Logical values pass through unchanged
+        float scale = physical ? fields.transforms[input.row()].scale : 1.0f;
+        float bias = physical ? fields.transforms[input.row()].bias : 0.0f;
 
-        for (size_t i = 0; i < NUM_BUFFERS; i++) {
-            int value = 0;
+        ReportHistory &history = dev->reports[dev->numbered ? report_id : 0];
+        if (!history.ring) return values;
 
-            switch(value_sz) {
-                case 4:
-                    value = *(uint32_t*)(dev->buffers[i].buffer + value_slot);
-                    break;
-                case 2:
-                    value = *(uint16_t*)(dev->buffers[i].buffer +value_slot);
-                    break;
-                case 1:
-                    value = dev->buffers[i].buffer[value_slot];
-                    break;
-                default:
-                    memcpy(&value, dev->buffers[i].buffer + value_slot, value_sz);
-            }
+        uint64_t head = history.ring->head();
 
-            if (bit_offset != 0) {
-                value >>= bit_offset;
-            }
+        // The whole ring is read below, so nothing written before now can be lost unseen.
+        history.observed.store(head, std::memory_order_relaxed);
 
-            if (input->report_size < 8) {
-                // TODO: Bit mask the non-required bytes
-                uint8_t mask = 0xFF >> (8 - input->report_size);
-                value &= mask;
-            }
-            
-            values[i] = (float)value;
-        }
+        // Values are read as signed when the field's logical range goes below 0.
+        bool is_signed = fields.logical_mins[input.row()] < 0;
 
-        return values; 
-    }
+        // Field offsets count from after the report ID, if there is one.
+        size_t skip = report_id != 0 ? 1 : 0;
 
-    void DeviceManager::readLoop(std::vector<DeviceInfo*> devices) {
-        while(true) {
-            auto next_tick = std::chrono::steady_clock::now() + std::chrono::microseconds( SAMPLE_INTERVAL );
+        // Reports are laid out oldest first, ending with the newest at the end of the series.
+        uint64_t first = head > NUM_BUFFERS ? head - NUM_BUFFERS : 0;
+        size_t start = NUM_BUFFERS - (size_t)(head - first);
+        size_t filled = start;
 
-            for (auto device : devices) {
-                auto next_buffer = device->current_buffer + 1;
-                if (next_buffer >= NUM_BUFFERS) next_buffer = 0;
+        history.ring->for_each(first, head, [&](uint64_t sequence, const DeviceBuffer &report) {
+            size_t i = start + (size_t)(sequence - first);
+            size_t length = (size_t)std::clamp(report.length, 0, (int)BUFFER_SIZE);
+            int32_t value = length > skip ? extract_bits(report.buffer + skip, length - skip, report_index, report_size, is_signed) : 0;
 
-                DeviceBuffer *n = &(device->buffers[next_buffer]);
+            // Slots which were overwritten mid-copy hold the value before them.
+            for (; filled < i; filled++) values[filled] = filled ? values[filled - 1] : 0;
 
-                n->length = hid_read(device->device, n->buffer, HID::BUFFER_SIZE);
-                n->lru = std::chrono::system_clock::now();
+            float number = is_signed ? (float)value : (float)(uint32_t)value;
 
-                if (n->length < 1) {
-                    // If the read timed out, copy the data from the previous buffer
-                    memcpy(n, &(device->buffers[device->current_buffer]), sizeof(DeviceBuffer));
-                }
+            values[i] = number * scale + bias;
+            filled = i + 1;
+        });
 
-                device->current_buffer = next_buffer;
-            }
+        for (; filled < NUM_BUFFERS; filled++) values[filled] = filled ? values[filled - 1] : 0;
 
-            std::this_thread::sleep_until(next_tick);
-        }
+        return values; 
     }
 
 }
\ No newline at end of file
@@ -1,49 +1,242 @@
 #pragma once
 
 #include <map>
+#include <memory>
+#include <set>
+#include <atomic>
 #include <chrono>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <thread>
 
+#include "descriptor_cache.hxx"
 #include "hid_descriptor.hxx"
+#include "histogram.hxx"
+#include "hotplug.hxx"
+#include "opener.hxx"
+#include "ring.hxx"
+#include "scheduler.hxx"
 
 #include <hidapi.h>
 
 namespace HID {
 
-    using UpdateRate = std::chrono::duration<std::chrono::system_clock, std::chrono::system_clock::period>;
+    /**
+     * Inter-arrival statistics of a device's reports.
+     *
+     * Repeated reports are excluded, and intervals are only measured between
+     * reports whose arrival was seen (see `DeviceBuffer::queued`), so polled
+     * devices have none. Times are in nanoseconds.
+     */
+    typedef struct {
+        // Number of intervals measured
+        size_t samples;
+
+        uint64_t min_interval;
+        uint64_t max_interval;
+        double mean_interval;
+        double stddev_interval;
+
+        // Reports per second over the held history, counted whether or not intervals could be measured
+        double rate;
+
+        // Mean time from arrival until the report had been read
+        double mean_latency;
+    } UpdateRate;
 
     typedef enum {
         SUCCESS,
         ERROR_UNDEFINED
     } InitResult;
 
+    /**
+     * How reader threads wait for reports.
+     *
+     * `Event` waits on the device handles and reads each report as it arrives,
+     * so capture follows the device's own report rate. Devices which can't be
+     * waited on are read on the `Polling` tick of `SAMPLE_INTERVAL` instead.
+     */
+    enum class CaptureMode : uint8_t {
+        Polling,
+        Event,
+    };
+
     // Sample Interval in μs
     const size_t SAMPLE_INTERVAL = 8333;
 
-    // Number of buffers to store. Total size requirement is NUM_BUFFERS * (BUFFER_SIZE + 16)
+    // Number of reports plotted per input
     const size_t NUM_BUFFERS  = 1200; //2000 / SAMPLE_INTERVAL;
 
-    // Size of each buffer.
-    const size_t BUFFER_SIZE  = 256;
+    /**
+     * Memory budget for a device's report history, shared evenly between its declared
+     * input reports once the few kept of undeclared ones are paid for. One report of up to 64 bytes (a full-speed endpoint's packet) keeps
+     * at least NUM_BUFFERS reports; devices with more reports keep fewer of each.
+     */
+    const size_t RING_BYTES = 128 * 1024;
+
+    // Fewest reports kept for any declared report, which only goes past RING_BYTES on devices with very many of them
+    const size_t MIN_RING_REPORTS = 64;
+
+    // Reports kept from IDs a numbered device's descriptor doesn't declare, which shouldn't turn up at all
+    const size_t STRAY_REPORTS = 64;
 
+    // Depth of the OS input report queue (hidraw's per-reader list, hidapi's Windows input buffers).
+    // Windows may have given a handle fewer buffers than asked for, so it's only what we expect.
+    const size_t OS_QUEUE_DEPTH = 64;
+
+    /**
+     * A snapshot of a device's capture totals.
+     */
     typedef struct {
-        int length;
-        unsigned char buffer[BUFFER_SIZE];  
-        std::chrono::time_point<std::chrono::system_clock> lru;
-    } DeviceBuffer;
+        // Reports read from the device
+        uint64_t reports_read;
+
+        // Wake-ups which drained at least `OS_QUEUE_DEPTH` reports, so the OS queue may have been
+        // full and have dropped some. A queue which only just filled up counts too.
+        uint64_t queue_possibly_full;
 
+        // Reports pushed out of the ring before any consumer took a snapshot of it
+        uint64_t ring_overwrites;
+    } DeviceCounters;
+
+    // Report IDs are a single byte; 0 means the device doesn't use them
+    const size_t MAX_REPORT_IDS = 256;
+
+    /**
+     * The captured history of one report ID.
+     */
     typedef struct {
-        hid_device *device;    
-        size_t current_buffer;
+        // Shared between the capture worker and consumers, null if the device doesn't send this report
+        std::unique_ptr<ReportRing> ring;
+
+        // The ring's head when a consumer last read the whole ring
+        std::atomic<uint64_t> observed;
+    } ReportHistory;
+
+    /**
+     * How far a device has been brought up.
+     *
+     * Devices start out `Enumerated`, which costs nothing but the entry itself.
+     * They are only opened and described, and then captured, once something
+     * asks for them (see `DeviceManager::describe` and `DeviceManager::capture`).
+     */
+    enum class DeviceState : uint8_t {
+        Enumerated,
+
+        // Being opened and described in the background (see `DeviceManager::request_describe`)
+        Opening,
+
+        Described,
+        Capturing,
+
+        // Opening the device or fetching its descriptor failed
+        Failed,
+
+        // Opening the device took longer than `OPEN_TIMEOUT`; it isn't retried
+        TimedOut,
+    };
+
+    typedef struct DeviceInfo {
+        std::string path;
+        DeviceState state;
+
+        uint16_t vendor_id;
+        uint16_t product_id;
+
+        // Null until the device is described
+        hid_device *device;
+
+        // How long opening the device and fetching its descriptor took
+        uint64_t open_ns;
+        uint64_t describe_ns;
+
+        // Waitable read handle for event capture, or -1 if the device is polled
+        int fd;
+
         struct {
             size_t length;
             unsigned char data[HID_API_MAX_REPORT_DESCRIPTOR_SIZE];
         } report_descriptor;
-        DeviceBuffer *buffers;
+
+        /**
+         * The parsed report descriptor, built once when the device is described.
+         *
+         * Never null: devices which haven't been (or couldn't be) described share an empty one.
+         */
+        std::shared_ptr<const Descriptor::Descriptor> descriptor;
+
+        // Usage of the first application collection (page in the high 16 bits), and whether the device has force feedback
+        uint32_t application_usage;
+        bool force_feedback;
+
+        // Whether the descriptor came from the descriptor cache rather than being parsed
+        bool cached;
+
+        // How long parsing the descriptor, or loading it from the cache, took
+        uint64_t parse_ns;
+
+        // Whether reports are prefixed with a report ID
+        bool numbered;
+
+        /**
+         * Captured reports by report ID, each with its own timestamps.
+         *
+         * Devices without report IDs only use `reports[0]`. On devices with report
+         * IDs it collects any report whose ID the descriptor doesn't declare, and only
+         * keeps the last `STRAY_REPORTS` of them.
+         */
+        ReportHistory reports[MAX_REPORT_IDS];
+
+        // ID of the report which was captured last
+        std::atomic<uint8_t> last_report_id;
+
+        // Capture totals, written by the reader thread
+        struct {
+            std::atomic<uint64_t> reports_read;
+            std::atomic<uint64_t> queue_possibly_full;
+            std::atomic<uint64_t> ring_overwrites;
+        } counters;
+
+        // Intervals between consecutive reports whose arrivals were seen, and the arrival
+        // of the last report if it was one of them, else 0 (capture thread only)
+        Histogram intervals;
+        uint64_t last_arrival;
+
+        // Set by the capture worker when reading fails because the device has gone
+        std::atomic<bool> disconnected;
+
+        // Set once a rescan has been asked for since `disconnected` was (UI thread only)
+        bool rescanned;
+
+        // Whether to capture the device as soon as it's done `Opening` (UI thread only)
+        bool capture_when_open;
+
+        // Index of the capture worker which reads this device, or -1
+        std::atomic<int> worker;
+
+        // Measured reports per second, and `reports_read` when it was last measured
+        std::atomic<uint32_t> rate;
+        uint64_t rate_mark;
     } DeviceInfo;
 
+    /**
+     * Read every report the OS has queued for the device into its ring.
+     *
+     * `wake` is the `Clock::now` time at which the worker learned a report was
+     * ready (or its polling tick fired); the first report drained is stamped with
+     * it as its arrival. Reports which were queued behind it are stamped when
+     * their read starts. Only the first report of an event wake arrived at its
+     * stamp, so every other report is flagged `queued` and left out of the
+     * interval statistics.
+     *
+     * Polled devices which had nothing queued repeat their previous report, so that
+     * their ring keeps advancing once per tick.
+     *
+     * Must only be called by the worker which owns the device.
+     */
+    size_t drain_reports(DeviceInfo *device, bool polled, uint64_t wake);
+
     class DeviceManager {
         public:
             ~DeviceManager();
@@ -59,46 +252,193 @@ namespace HID {
             const hid_device_info* get_devices(void);
 
             /**
-             * Get the latest report for the given device.
+             * Apply any devices which were plugged in or removed since the last call.
+             *
+             * Must be called from the thread which walks the device list, between walks.
+             * Returns true if the list changed, in which case `hid_device_info` pointers
+             * to removed devices are no longer valid.
+             */
+            bool update(void);
+
+            /**
+             * Get a consistent copy of the latest report for the given device.
+             *
+             * The length is -1 if the device hasn't reported anything yet.
              */
-            const DeviceBuffer* get_latest_report(const hid_device_info *device);
+            DeviceBuffer get_latest_report(const hid_device_info *device);
+
+            /**
+             * Get a consistent copy of the latest report with the given ID.
+             */
+            DeviceBuffer get_latest_report(const hid_device_info *device, uint8_t report_id);
 
             const DeviceInfo* get_device(const hid_device_info *device);
 
             /**
              * Get the I/O handle for the specified device to interact with it directly.
+             *
+             * Opens the device if it hasn't been yet. Returns null if it can't be opened.
              */
             hid_device* open_device(const hid_device_info *device);
 
-            void get_update_rate(const hid_device_info *device);
+            /**
+             * Open the device and fetch its report descriptor, if that hasn't been done yet.
+             *
+             * Returns null if the device isn't known; check `state` for whether it could be opened.
+             */
+            const DeviceInfo* describe(const hid_device_info *device);
+
+            /**
+             * Start opening the device and fetching its report descriptor in the background,
+             * if that hasn't been done yet, so the caller never waits on a slow device.
+             *
+             * The device stays `Opening` until a later `update` picks up the result.
+             * Returns null if the device isn't known.
+             */
+            const DeviceInfo* request_describe(const hid_device_info *device);
+
+            /**
+             * Like `request_describe`, and start capturing the device once it's described.
+             */
+            const DeviceInfo* request_capture(const hid_device_info *device);
 
             /**
-             * 
+             * Describe every known device at once, opening them in parallel.
+             */
+            void describe_all();
+
+            /**
+             * Start capturing the device's reports, describing it first if needed.
+             *
+             * Returns null if the device isn't known; check `state` for whether it could be opened.
+             */
+            const DeviceInfo* capture(const hid_device_info *device);
+
+            /**
+             * Capture devices with this vendor and product ID as soon as they're enumerated,
+             * rather than waiting for something to ask for them.
+             *
+             * Must be called before the device manager is initialized to apply to the initial enumeration.
+             */
+            void add_profile_device(uint16_t vendor_id, uint16_t product_id);
+
+            /**
+             * Keep parsed descriptors in a cache file at `path`, and take them from it
+             * for devices whose descriptor is already there rather than parsing them again.
+             *
+             * Must be called before the device manager is initialized. Without it nothing is cached.
+             */
+            void set_descriptor_cache(const std::string &path);
+
+            /**
+             * Measure the report inter-arrival times over the device's held history.
+             */
+            UpdateRate get_update_rate(const hid_device_info *device);
+
+            /**
+             * Get the report interval distribution and detected polling rate for the given device.
+             *
+             * Unlike `get_update_rate` this covers every report since the device was
+             * opened (or last reset), not just the held history.
              */
-            float* get_input_series(const hid_device_info *device, const Descriptor::Node *input);
+            IntervalStats get_interval_stats(const hid_device_info *device);
+
+            /**
+             * Clear the interval statistics of the given device.
+             */
+            void reset_interval_stats(const hid_device_info *device);
+
+            /**
+             * Get the capture totals for the given device.
+             *
+             * Comparing `reports_read` against the device's report rate, and checking
+             * the queue full and overwrite counts stay at zero, shows nothing was lost.
+             */
+            DeviceCounters get_counters(const hid_device_info *device);
+
+            /**
+             * Select how devices are captured.
+             *
+             * Takes effect for reader threads started after the call, so it should
+             * be set before the device manager is initialized.
+             */
+            void set_capture_mode(CaptureMode mode);
+            CaptureMode get_capture_mode(void);
+
+            /**
+             * Set the number of capture worker threads.
+             *
+             * 0 (the default) uses one per core, up to `DEFAULT_MAX_READERS`.
+             * Must be set before the device manager is initialized.
+             */
+            void set_reader_threads(size_t count);
+
+            /**
+             * Get the capture scheduler, to inspect worker assignments and load.
+             */
+            Scheduler& get_scheduler(void);
+
+            /**
+             * Decode an input from every report held for the device.
+             *
+             * Only reports with the input's report ID are read. `input` is a field of
+             * the device's own descriptor (see `DeviceInfo::descriptor`).
+             *
+             * Returns `NUM_BUFFERS` values ordered oldest to newest, which the caller must free.
+             * Slots without a consistent report repeat the value before them.
+             *
+             * With `physical` set the values are converted to the input's physical units
+             * (see `FieldTable::physical`) rather than left as logical values.
+             */
+            float* get_input_series(const hid_device_info *device, Descriptor::FieldHandle input, bool physical = false);
         private:
 
             /**
-             * A single-linked list of HID interfaces
+             * A single-linked list of HID interfaces.
+             *
+             * The nodes are copies owned by the device manager (see `copy_device_info`),
+             * so that devices can be added and removed individually.
              */
-            hid_device_info *devices;
+            hid_device_info *devices = nullptr;
 
             /**
              * The number of devices
              */
-            size_t device_count;
+            size_t device_count = 0;
 
             /**
-             * The raw IO handles to each device
+             * The raw IO handles to each device, by path
              */
-            std::map<char*,DeviceInfo*> handles;
+            std::map<std::string, DeviceInfo*, std::less<>> handles;
 
             /**
-             * A pool of worker threads which poll the devices for inputs
-            */
-            std::vector<std::thread> readers;
+             * Watches for devices being plugged in or removed
+             */
+            HotplugMonitor hotplug;
+
+            /**
+             * The capture workers which read the devices
+             */
+            Scheduler scheduler;
+
+            /**
+             * Opens devices and fetches their descriptors, off the caller's thread
+             */
+            Opener opener;
+
+            /**
+             * Devices `Opening` in the background, by the ID of their `Opener::open_async`
+             */
+            std::map<uint64_t, DeviceInfo*> opening;
+
+            /**
+             * Requested number of capture workers, 0 for the default
+             */
+            size_t reader_threads = 0;
 
-            bool initialized;
+            CaptureMode capture_mode = CaptureMode::Event;
+
+            bool initialized = false;
             
             /**
              * Initializer
@@ -106,15 +446,75 @@ namespace HID {
             void init();
 
             /**
-             * Timer loop to read a device.
-             *
-             * Devices are multi-buffered.
-             * When reading a report it is stored in buffer ahead of the
-             * one being returned by `DeviceManager::get_latest_report`
+             * Vendor and product IDs (`vendor << 16 | product`) which are captured as soon as they appear
+             */
+            std::set<uint32_t> profile;
+
+            /**
+             * Parsed descriptors from earlier runs
+             */
+            DescriptorCache descriptor_cache;
+
+            /**
+             * Start tracking an enumerated device without opening it.
+             */
+            DeviceInfo* track(const hid_device_info *device);
+
+            /**
+             * Open the device and fetch its descriptor. Returns false if that failed.
+             */
+            bool describe(DeviceInfo *device);
+
+            /**
+             * Open and describe any of `devices` which haven't been yet, all in parallel.
+             */
+            void describe(const std::vector<DeviceInfo*> &devices);
+
+            /**
+             * Finish describing a device from the result of opening it.
+             */
+            void describe(DeviceInfo *device, const OpenResult &result);
+
+            /**
+             * Start opening the device in the background, if it hasn't been yet.
              */
-            void readLoop(std::vector<DeviceInfo*> devices);
+            void open_async(DeviceInfo *device);
+
+            /**
+             * Finish describing the devices whose background opens are done, and
+             * capture those which were asked for.
+             */
+            void take_opened();
+
+            /**
+             * Whether the device is in the profile, and should be captured as soon as it's enumerated.
+             */
+            bool in_profile(const hid_device_info *device);
+
+            /**
+             * Allocate the device's rings and hand it to the capture workers.
+             */
+            bool capture(DeviceInfo *device);
+
+            /**
+             * Stop capturing the device and release everything it acquired.
+             */
+            void close(DeviceInfo *device);
+
+            /**
+             * Close a device whose reads failed but which is still present, and open it
+             * again, capturing it again if it was being captured.
+             */
+            void reopen(DeviceInfo *device);
+
+            /**
+             * When the last rescan for disconnected devices was asked for
+             */
+            std::chrono::steady_clock::time_point last_rescan;
+
+            DeviceInfo* find(const hid_device_info *device);
     };
 
-    static DeviceManager GlobalDeviceManager;
+    extern DeviceManager GlobalDeviceManager;
 
 }
\ No newline at end of file
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <array>
 #include <bitset>
 
@@ -5,10 +6,15 @@
 #include <stdint.h>
 #include <stdio.h>
 
+#include <boost/iterator/counting_iterator.hpp>
+#include <boost/iterator/filter_iterator.hpp>
+#include <boost/iterator/transform_iterator.hpp>
+
 #include <fmt/format.h>
 #include <fmt/ranges.h>
 
 #include "hid_descriptor.hxx"
+#include "usage_tables.hxx"
 
 #if (_DEBUG)
     //#define LOG(FMT, ...) fmt::println(FMT, __VA_ARGS__)
@@ -20,140 +26,218 @@
 namespace HID {
     namespace Descriptor {
 
-        using GlobalParams = std::array<int32_t, 10>;
-        using LocalParams = std::map<LocalItemTag, std::vector<int32_t>>;
-
-        uint32_t index = 0;
-
-        int32_t parse_hid_report_get_item_data(const uint8_t *buffer, uint8_t item_sz) {
-            if (item_sz == 1) return *buffer;             // Return 1 byte
-            if (item_sz == 2) return *((int16_t*)buffer); // Return 2 bytes
-            if (item_sz == 4) return *((int32_t*)buffer); // Return 4 bytes
-            return 0;
+        // Index of a report type in per-type tables
+        inline size_t type_slot(MainItemTag type) {
+            return type == MainItemTag::INPUT ? 0 : (type == MainItemTag::OUTPUT ? 1 : 2);
         }
-
-        uint8_t item_size(uint8_t value);
         UsagePage usage_page(uint8_t value);
         ReportItemType report_item_type(uint8_t value);
 
-        void global_item(uint8_t tag, uint8_t data_sz, int32_t data, std::vector<GlobalParams> *state);
-        void main_item  (
-            Descriptor *d, 
-            uint8_t tag, 
-            uint8_t data_sz, 
-            int32_t data, 
-            GlobalParams params, 
-            LocalParams *local, 
-            uint8_t *collection_depth
-        );
-
-        void local_item (uint8_t tag, int32_t data, LocalParams *state);
-        void node      (Descriptor *d, uint8_t data_sz, int32_t data, GlobalParams params, LocalParams *local, MainItemTag type);
-
         Descriptor parse(const unsigned char *buffer, size_t buffer_sz) {
-            size_t idx = 0;
-            index = 0;
-
-            // Global state values which can be changed by a GLOBAL command
-            // These can be stacked... because of course..
-            std::vector<GlobalParams> state;
-            state.reserve(2);
-            state.push_back({});
-            
-            uint8_t collection_depth = 0;
-            LocalParams local_state = {};
-            Descriptor descriptor = {};
-
-            while(idx < buffer_sz) {
-                uint8_t mark = buffer[idx];
-                uint8_t item_sz  = item_size(buffer[idx] & SIZE_MASK);
-
-                int32_t data = parse_hid_report_get_item_data(&buffer[idx+1], item_sz);
-
-                ReportItemType item_type = (ReportItemType)(mark & TYPE_MASK);
-                uint8_t tag = mark >> 4;
+            Parser parser;
+            return parser.parse(buffer, buffer_sz);
+        }
 
-                switch (item_type) {
+        Descriptor Parser::parse(const unsigned char *buffer, size_t buffer_sz) {
+            report_order_length = {};
+            reports_used = {};
+            collection_depth = 0;
+            collection_overflow = 0;
+            collection_list.clear();
+            for (auto &nodes : node_lists) nodes.clear();
+            array_list.clear();
+            array_usage_list.clear();
+            clear_locals();
+
+            globals[0] = {};
+            global_depth = 0;
+            global_overflow = 0;
+
+            for (auto &item : Items(buffer, buffer_sz)) {
+                switch (item.type) {
                     case ReportItemType::MAIN_ITEM:
-                        main_item(&descriptor, tag, item_sz, data, state.back(), &local_state, &collection_depth);
+                        main_item(item.tag, item.size, (int32_t)item.data);
 
-                        // Local state does not carry over to the next main item out of a collection
-                        if (collection_depth == 0 || tag == MainItemTag::END_COLLECTION) local_state = {};
+                        // Local items only ever apply to the main item which follows them
+                        clear_locals();
                         break;
                     case ReportItemType::GLOBAL_ITEM:
-                        global_item(tag, item_sz, data, &state);
+                        global_item(item);
                         break;
                     case ReportItemType::LOCAL_ITEM:
-                        local_item(tag, data, &local_state);
+                        local_item(item.tag, (int32_t)item.data);
                     default:
                         break;
                 }
-
-                idx += item_sz + 1;
             }
 
-            return descriptor;
-        }
+            // Collections left open run to the end of the descriptor
+            while (collection_depth > 0) end_collection();
+
+            // Only built once every list is complete, so each of its tables is allocated just the once,
+            // and belongs to the caller alone: the parser keeps nothing of it
+            Descriptor descriptor = {
+                .inputs = node_lists[0],
+                .outputs = node_lists[1],
+                .features = node_lists[2],
+                .input_fields = {},
+                .output_fields = {},
+                .feature_fields = {},
+                .layouts = {},
+                .layout_fields = {},
+                .collections = collection_graph(collection_list),
+                .arrays = array_list,
+                .array_usages = array_usage_list,
+            };
+
+            build_layouts(descriptor);
+            build_fields(descriptor);
 
-        uint8_t item_size(uint8_t item) {
-            uint8_t maskedSize = item & SIZE_MASK;
-
-            return (maskedSize == 3 ? 4 : maskedSize);
+            return descriptor;
         }
 
         UsagePage usage_page(uint8_t value) {
             return (UsagePage)(0x01 << 2 | value & SIZE_MASK);
         }
 
-        inline void global_item(uint8_t tag, uint8_t data_sz, int32_t data, std::vector<GlobalParams> *state) {
+        void Parser::global_item(const Item &item) {
+            uint8_t tag = item.tag;
+            GlobalParams &params = globals[global_depth];
+
             assert(tag <= GlobalItemTag::POP);
-            auto p = state->back();
 
             switch(tag) {
                 case GlobalItemTag::PUSH:
-                    state->push_back(p);
+                    if (global_depth + 1 < MAX_GLOBAL_DEPTH) {
+                        globals[global_depth + 1] = globals[global_depth];
+                        global_depth++;
+                    } else {
+                        global_overflow++;
+                    }
                     break;
                 case GlobalItemTag::POP:
-                    if (state->size() > 1) state->pop_back();
+                    if (global_overflow > 0) {
+                        global_overflow--;
+                    } else if (global_depth > 0) {
+                        global_depth--;
+                    }
+                    break;
+                case GlobalItemTag::LOGICAL_MINIMUM:
+                case GlobalItemTag::PHYSICAL_MINIMUM:
+                case GlobalItemTag::UNIT_EXPONENT:
+                    params[tag] = item.signed_data;
+                    break;
+                case GlobalItemTag::LOGICAL_MAXIMUM:
+                case GlobalItemTag::PHYSICAL_MAXIMUM:
+                    // Plenty of devices give an unsigned maximum (0xFF in one byte for 255), so
+                    // like most hosts the maximum is only taken as signed when the minimum is negative
+                    params[tag] = params[tag == GlobalItemTag::LOGICAL_MAXIMUM ? GlobalItemTag::LOGICAL_MINIMUM : GlobalItemTag::PHYSICAL_MINIMUM] < 0
+                        ? item.signed_data
+                        : (int32_t)item.data;
                     break;
                 default:
-                    state->pop_back();
-                    p[tag] = data;
-                    state->push_back(p);
+                    // Reserved tags have nowhere to go
+                    if (tag >= params.size()) break;
+
+                    params[tag] = (int32_t)item.data;
                     break;
             }
         }
 
-        void main_item(Descriptor *d, uint8_t tag, uint8_t data_sz, int32_t data, GlobalParams params, LocalParams *local, uint8_t *collection_depth) {
+        void Parser::main_item(uint8_t tag, uint8_t data_sz, int32_t data) {
             assert(tag <= MainItemTag::END_COLLECTION);
 
             switch (tag) {
                 case MainItemTag::INPUT:
                 case MainItemTag::OUTPUT:
                 case MainItemTag::FEATURE:
-                    node(d, data_sz, data, params, local, (MainItemTag)tag);
+                    node(data_sz, data, (MainItemTag)tag);
                     break;
                 case MainItemTag::COLLECTION:
-                    collection_depth++;
+                    start_collection(data);
                     break;
-                case MainItemTag::END_COLLECTION: 
-                    collection_depth--;
+                case MainItemTag::END_COLLECTION:
+                    if (collection_overflow > 0) {
+                        collection_overflow--;
+                    } else if (collection_depth > 0) {
+                        end_collection();
+                    }
                     break;
             }
         }
 
-        void local_item(uint8_t tag, int32_t data, LocalParams *state) {
-            LocalItemTag t = (LocalItemTag) tag;
-            if ( state->contains(t) ) {
-                state->at(t).push_back(data);
-                std::rotate(state->at(t).rbegin(), state->at(t).rbegin() + 1, state->at(t).rend());
-            } else {
-                std::vector<int32_t> value = { data };
-                state->emplace(t, value);
+        void Parser::start_collection(int32_t data) {
+            if (collection_depth == MAX_COLLECTION_DEPTH) {
+                collection_overflow++;
+                return;
             }
+
+            const GlobalParams &params = globals[global_depth];
+            uint32_t usage = has_local(LocalItemTag::Usage) ? (uint32_t)take_local(LocalItemTag::Usage) : 0;
+
+            // A four byte usage brings its own page
+            uint16_t usage_page = usage >> 16 ? (uint16_t)(usage >> 16) : (uint16_t)params[GlobalItemTag::USAGE_PAGE];
+
+            std::array<uint32_t, 3> first = {
+                (uint32_t)node_lists[0].size(),
+                (uint32_t)node_lists[1].size(),
+                (uint32_t)node_lists[2].size(),
+            };
+
+            uint32_t parent = collection_depth > 0 ? collection_stack[collection_depth - 1] : NO_COLLECTION;
+
+            collection_list.push_back({
+                .type = (CollectionType)(uint8_t)data,
+                .usage_page = usage_page,
+                .usage = (uint16_t)usage,
+                .parent = parent,
+                .first_field = first,
+                .end_field = first,
+            });
+
+            collection_stack[collection_depth++] = (uint32_t)(collection_list.size() - 1);
+        }
+
+        void Parser::end_collection() {
+            uint32_t index = collection_stack[--collection_depth];
+
+            collection_list[index].end_field = {
+                (uint32_t)node_lists[0].size(),
+                (uint32_t)node_lists[1].size(),
+                (uint32_t)node_lists[2].size(),
+            };
+        }
+
+        void Parser::local_item(uint8_t tag, int32_t data) {
+            if (local_count == MAX_LOCAL_ITEMS) return;
+
+            local_values[local_count] = data;
+            local_tags[local_count] = (LocalItemTag) tag;
+            local_count++;
+        }
+
+        void Parser::clear_locals() {
+            local_count = 0;
+            local_next = {};
+        }
+
+        bool Parser::has_local(LocalItemTag tag) {
+            uint16_t &next = local_next[(uint8_t)tag & 0x0F];
+
+            while (next < local_count && local_tags[next] != tag) next++;
+
+            return next < local_count;
         }
 
-        void node(Descriptor *d, uint8_t data_sz, int32_t data, GlobalParams params, LocalParams *local, MainItemTag tag) {
+        int32_t Parser::take_local(LocalItemTag tag) {
+            uint16_t &next = local_next[(uint8_t)tag & 0x0F];
+
+            return local_values[next++];
+        }
+
+        void Parser::node(uint8_t data_sz, int32_t data, MainItemTag tag) {
+            const GlobalParams &params = globals[global_depth];
+
             int32_t report_count = params[GlobalItemTag::REPORT_COUNT],
                     report_id = params[GlobalItemTag::REPORT_ID],
                     report_size = params[GlobalItemTag::REPORT_SIZE],
@@ -164,11 +248,6 @@ namespace HID {
                     units = params[GlobalItemTag::UNIT],
                     unit_exp = params[GlobalItemTag::UNIT_EXPONENT];
 
-            auto usage_min_it = local->find(LocalItemTag::UsageMin),
-                 usage_max_it = local->find(LocalItemTag::UsageMax),
-                 string_min_it = local->find(LocalItemTag::StringMin),
-                 string_max_it = local->find(LocalItemTag::StringMax);
-
             uint16_t usage_id = 0,
                      usage_min = 0,
                      usage_max = 0;
@@ -177,108 +256,571 @@ namespace HID {
                     string_min = 0,
                     string_max = 0;
 
-            if (usage_min_it != local->end() && usage_max_it != local->end()) {
-                if (!usage_min_it->second.empty() && !usage_max_it->second.empty()) {
-                    usage_max = usage_id = (uint16_t) usage_max_it->second.back();
-                    usage_min = (uint16_t) usage_min_it->second.back();
-                    usage_max_it->second.pop_back();
-                    usage_min_it->second.pop_back();
-                }
+            // Ranges are told apart by their items being there, since either end may be 0
+            bool usage_range = has_local(LocalItemTag::UsageMin) && has_local(LocalItemTag::UsageMax);
+            bool string_range = has_local(LocalItemTag::StringMin) && has_local(LocalItemTag::StringMax);
+
+            if (usage_range) {
+                usage_min = (uint16_t) take_local(LocalItemTag::UsageMin);
+                usage_max = (uint16_t) take_local(LocalItemTag::UsageMax);
             }
 
-            if (string_min_it != local->end() && usage_max_it != local->end()) {
-                if (!string_max_it->second.empty() && string_min_it->second.empty()) {
-                    string_max = string_id = (uint16_t) string_max_it->second.back();
-                    string_min = (uint16_t) string_min_it->second.back();
-                    string_min_it->second.pop_back();
-                    string_max_it->second.pop_back();
+            if (string_range) {
+                string_min = (uint16_t) take_local(LocalItemTag::StringMin);
+                string_max = (uint16_t) take_local(LocalItemTag::StringMax);
+            }
+
+            size_t slot = type_slot(tag);
+            auto &nodes = node_lists[slot];
+
+            // Each report's fields start over from its first bit
+            if (!reports_used[slot][(uint8_t)report_id]) {
+                reports_used[slot][(uint8_t)report_id] = true;
+                report_bits[slot][(uint8_t)report_id] = 0;
+                report_fields[slot][(uint8_t)report_id] = 0;
+                report_order[slot][report_order_length[slot]++] = (uint8_t)report_id;
+            }
+
+            uint32_t &offset = report_bits[slot][(uint8_t)report_id];
+
+            // Padding is declared as a constant array, but holds no controls
+            bool array = !(data & (int32_t)InputProperty::Constant) && !(data & (int32_t)InputProperty::Variable);
+
+            if (array && report_count > 0 && report_size > 0 && report_size <= 32) {
+                ArrayField field = {
+                    .type = tag,
+                    .report_id = (uint8_t)report_id,
+                    .offset = offset,
+                    .size = (uint8_t)report_size,
+                    .count = (uint32_t)report_count,
+                    .logical_min = logical_min,
+                    .logical_max = logical_max,
+                    .usage_page = (uint16_t)params[GlobalItemTag::USAGE_PAGE],
+                    .usage_min = usage_min,
+                    .usage_max = usage_max,
+                    .first_usage = (uint32_t)array_usage_list.size(),
+                    .usage_count = 0,
+                    .first_field = (uint32_t)nodes.size(),
+                };
+
+                if (!usage_range) {
+                    // Only looked at: the slots below still take these one each, as for any other field
+                    for (size_t i = local_next[(uint8_t)LocalItemTag::Usage]; i < local_count; i++) {
+                        if (local_tags[i] == LocalItemTag::Usage) array_usage_list.push_back((uint16_t)local_values[i]);
+                    }
+
+                    field.usage_count = (uint32_t)array_usage_list.size() - field.first_usage;
                 }
+
+                array_list.push_back(field);
             }
 
+            if (report_count <= 0) return;
+
+            // Everything but the usage, string and offset is the same for every field of the item
+            Node v = {
+                .usage_page = (UsagePage)params[GlobalItemTag::USAGE_PAGE],
+                .report_id = (uint16_t)report_id,
+                .report_size = (uint8_t)report_size,
+                .min_value = logical_min,
+                .max_value = logical_max,
+                .physical_min = physical_min,
+                .physical_max = physical_max,
+                .unit = (uint32_t)units,
+                .unit_exp = Unit::decode_exponent(unit_exp),
+                .collection = collection_depth > 0 ? collection_stack[collection_depth - 1] : NO_COLLECTION,
+                .flags = (uint16_t)data,
+            };
+
+            // Every field starts as a copy of the item's, laid down in one go, and is then given its own
+            // usage, string and offset; copies made one by one would each wait on stores just made
+            size_t first = nodes.size();
+            nodes.resize(first + report_count, v);
+
             for (auto i = 0; i < report_count; i++) {
-                if (usage_max && usage_min) {
-                    usage_id--;
+                // Fields take a range's usages in order, and any past its end take its last
+                if (usage_range) {
+                    usage_id = (uint16_t)std::min<uint32_t>(usage_min + i, usage_max);
+                } else if (has_local(LocalItemTag::Usage)) {
+                    usage_id = take_local(LocalItemTag::Usage);
+                }
+
+                if (string_range) {
+                    string_id = (uint16_t)std::min<uint32_t>(string_min + i, string_max);
+                } else if (has_local(LocalItemTag::StringIndex)) {
+                    string_id = take_local(LocalItemTag::StringIndex);
                 } else {
-                    auto usage = local->find(LocalItemTag::Usage);
+                    string_id = 0xffff;
+                }
 
-                    if (usage != local->end()) {
-                        if (!usage->second.empty()) {
-                            usage_id = usage->second.back();
-                            usage->second.pop_back();
-                        }
-                    }
+                Node &field = nodes[first + i];
+                field.usage_id = usage_id;
+                field.string_index = string_id;
+                field.report_index = offset;
+
+                offset += report_size;
+            }
+
+            report_fields[slot][(uint8_t)report_id] += report_count;
+        }
+
+        void Parser::build_layouts(Descriptor &descriptor) {
+            const MainItemTag types[] = { MainItemTag::INPUT, MainItemTag::OUTPUT, MainItemTag::FEATURE };
+
+            size_t layout_count = 0;
+
+            for (size_t slot = 0; slot < 3; slot++) {
+                for (size_t i = 0; i < report_order_length[slot]; i++) {
+                    if (report_fields[slot][report_order[slot][i]] > 0) layout_count++;
                 }
+            }
 
-                if (string_max && string_min) {
-                    string_id--;
-                } else {
-                    auto str = local->find(LocalItemTag::StringIndex);
-                    if (str != local->end()) {
-                        string_id = str->second.back();
-                        str->second.pop_back();
-                    } else {
-                        string_id = 0xffff;
-                    }
+            descriptor.layouts.reserve(layout_count);
+            descriptor.layout_fields.resize(descriptor.inputs.size() + descriptor.outputs.size() + descriptor.features.size());
+
+            uint32_t cursor = 0;
+
+            for (size_t slot = 0; slot < 3; slot++) {
+                auto &nodes = descriptor.nodes(types[slot]);
+                auto first = report_order[slot].begin(), last = first + report_order_length[slot];
+
+                std::sort(first, last);
+
+                for (auto it = first; it != last; it++) {
+                    uint8_t report_id = *it;
+                    uint32_t count = report_fields[slot][report_id];
+
+                    if (count == 0) continue;
+
+                    descriptor.layouts.push_back({
+                        .type = types[slot],
+                        .report_id = report_id,
+                        .length = (report_bits[slot][report_id] + 7) / 8 + (report_id != 0 ? 1 : 0),
+                        .first_field = cursor,
+                        .field_count = count,
+                    });
+
+                    // From here on, where the report's next field goes in `layout_fields`
+                    report_fields[slot][report_id] = cursor;
+                    cursor += count;
                 }
-                        
-
-                Node v = {
-                    .usage_page = (UsagePage)params[GlobalItemTag::USAGE_PAGE],
-                    .report_id = (uint16_t)report_id,
-                    .usage_id = usage_id,
-                    .string_index = string_id,
-                    .report_size = (uint8_t)report_size,
-                    .report_index = index,
-                    .min_value = logical_min,
-                    .max_value = logical_max,
-                    .physical_min = physical_min,
-                    .physical_max = physical_max,
-                };
 
-                switch(tag) {
-                    case MainItemTag::INPUT:
-                        d->inputs.push_back(v);
+                // Offsets within a report only ever grow, so fields are already in order.
+                for (uint32_t i = 0; i < nodes.size(); i++) {
+                    descriptor.layout_fields[report_fields[slot][(uint8_t)nodes[i].report_id]++] = i;
+                }
+            }
+        }
+
+        /**
+         * The scale and bias which take a field's logical values to physical ones.
+         *
+         * The logical range maps linearly onto the physical range, which is then scaled
+         * by the unit exponent. A field without a physical range (both ends 0) uses its
+         * logical range for both, as does one whose logical range is empty.
+         */
+        static PhysicalTransform physical_transform(const Node &node) {
+            // Unit exponents run from -8 to 7
+            static const double powers_of_ten[16] = {
+                1e-8, 1e-7, 1e-6, 1e-5, 1e-4, 1e-3, 1e-2, 1e-1, 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+            };
+
+            double magnitude = powers_of_ten[(node.unit_exp + 8) & 0xF];
+            double logical = (double)node.max_value - node.min_value;
+            double physical = (double)node.physical_max - node.physical_min;
+
+            if ((node.physical_min == 0 && node.physical_max == 0) || logical == 0) {
+                return { (float)magnitude, 0.0f };
+            }
+
+            double scale = physical / logical;
+            double bias = node.physical_min - node.min_value * scale;
+
+            return { (float)(scale * magnitude), (float)(bias * magnitude) };
+        }
+
+        void Parser::build_fields(Descriptor &descriptor) {
+            FieldTable *tables[] = { &descriptor.input_fields, &descriptor.output_fields, &descriptor.feature_fields };
+            const MainItemTag types[] = { MainItemTag::INPUT, MainItemTag::OUTPUT, MainItemTag::FEATURE };
+
+            for (size_t slot = 0; slot < 3; slot++) {
+                auto &nodes = descriptor.nodes(types[slot]);
+                auto &table = *tables[slot];
+
+                table.type = types[slot];
+
+                size_t count = nodes.size();
+
+                table.report_ids.reserve(count);
+                table.offsets.reserve(count);
+                table.sizes.reserve(count);
+                table.usage_pages.reserve(count);
+                table.usages.reserve(count);
+                table.logical_mins.reserve(count);
+                table.logical_maxs.reserve(count);
+                table.transforms.reserve(count);
+                table.collections.reserve(count);
+
+                for (size_t i = 0; i < count; i++) {
+                    const Node &node = nodes[i];
+
+                    table.report_ids.push_back((uint8_t)node.report_id);
+                    table.offsets.push_back(node.report_index);
+                    table.sizes.push_back(node.report_size);
+                    table.usage_pages.push_back((uint16_t)node.usage_page);
+                    table.usages.push_back((uint16_t)node.usage_id);
+                    table.logical_mins.push_back(node.min_value);
+                    table.logical_maxs.push_back(node.max_value);
+
+                    // Fields of one main item share their ranges, so most can take the last field's transform
+                    bool same_ranges = i > 0 && node.min_value == nodes[i - 1].min_value && node.max_value == nodes[i - 1].max_value
+                        && node.physical_min == nodes[i - 1].physical_min && node.physical_max == nodes[i - 1].physical_max
+                        && node.unit_exp == nodes[i - 1].unit_exp;
+
+                    table.transforms.push_back(same_ranges ? table.transforms.back() : physical_transform(node));
+                    table.collections.push_back(node.collection);
+                }
+            }
+        }
+
+        std::vector<uint8_t> report_ids(const unsigned char *buffer, size_t buffer_sz) {
+            std::bitset<256> declared;
+
+            for (auto &item : Items(buffer, buffer_sz)) {
+                if (item.type == ReportItemType::GLOBAL_ITEM && item.tag == GlobalItemTag::REPORT_ID) {
+                    declared.set((uint8_t)item.data);
+                }
+            }
+
+            std::vector<uint8_t> ids;
+
+            for (size_t id = 1; id < declared.size(); id++) {
+                if (declared[id]) ids.push_back((uint8_t)id);
+            }
+
+            return ids;
+        }
+
+        uint32_t application_usage(const unsigned char *buffer, size_t buffer_sz) {
+            // Only the usage page matters here, but it's still pushed and popped like every other global
+            std::array<uint16_t, MAX_GLOBAL_DEPTH> pages = {};
+            size_t depth = 0, overflow = 0;
+
+            // The first usage since the last main item, with its page, or 0
+            uint32_t usage = 0;
+
+            for (auto &item : Items(buffer, buffer_sz)) {
+                switch (item.type) {
+                    case ReportItemType::MAIN_ITEM:
+                        if (item.tag == MainItemTag::COLLECTION && item.data == (uint32_t)CollectionType::Application) {
+                            return usage;
+                        }
+
+                        usage = 0;
                         break;
-                    case MainItemTag::OUTPUT:
-                        d->outputs.push_back(v);
+                    case ReportItemType::GLOBAL_ITEM:
+                        if (item.tag == GlobalItemTag::USAGE_PAGE) {
+                            pages[depth] = (uint16_t)item.data;
+                        } else if (item.tag == GlobalItemTag::PUSH) {
+                            if (depth + 1 < MAX_GLOBAL_DEPTH) {
+                                pages[depth + 1] = pages[depth];
+                                depth++;
+                            } else {
+                                overflow++;
+                            }
+                        } else if (item.tag == GlobalItemTag::POP) {
+                            if (overflow > 0) {
+                                overflow--;
+                            } else if (depth > 0) {
+                                depth--;
+                            }
+                        }
                         break;
-                    case MainItemTag::FEATURE:
-                        d->features.push_back(v);
+                    case ReportItemType::LOCAL_ITEM:
+                        if (usage != 0 || item.tag != (uint8_t)LocalItemTag::Usage) break;
+
+                        // A four byte usage brings its own page
+                        usage = item.size == 4 ? item.data : (uint32_t)pages[depth] << 16 | (uint16_t)item.data;
+                        break;
+                    default:
                         break;
                 }
+            }
+
+            return 0;
+        }
 
-                index += report_size;
+        bool is_pid_device(const unsigned char *buffer, size_t buffer_sz) {
+            for (auto &item : Items(buffer, buffer_sz)) {
+                bool pid_page = item.type == ReportItemType::GLOBAL_ITEM && item.tag == GlobalItemTag::USAGE_PAGE && item.data == UsagePage::PID;
+                bool pid_usage = item.type == ReportItemType::LOCAL_ITEM && item.size == 4 && (item.data >> 16) == UsagePage::PID;
+
+                if (pid_page || pid_usage) return true;
             }
+
+            return false;
         }
 
-        UsageDef find_usage_definition(uint16_t usage_page, uint16_t usage_type) {
-            if (usage_page >= 0xFF00) {
-                return { (UsagePage)usage_page, 0x00, 0xFFFF, NULL, "Vendor-Defined" };
+        FieldHandle FieldTable::handle(uint32_t row) const {
+            return FieldHandle((uint8_t)type_slot(type), row);
+        }
+
+        const FieldTable& Descriptor::fields(MainItemTag type) const {
+            if (type == MainItemTag::OUTPUT) return output_fields;
+            if (type == MainItemTag::FEATURE) return feature_fields;
+
+            return input_fields;
+        }
+
+        const FieldTable& Descriptor::fields(FieldHandle field) const {
+            if (field.slot() == 1) return output_fields;
+            if (field.slot() == 2) return feature_fields;
+
+            return input_fields;
+        }
+
+        const std::vector<Node>& Descriptor::nodes(MainItemTag type) const {
+            if (type == MainItemTag::OUTPUT) return outputs;
+            if (type == MainItemTag::FEATURE) return features;
+
+            return inputs;
+        }
+
+        const ReportLayout* Descriptor::layout(MainItemTag type, uint8_t report_id) const {
+            auto it = std::lower_bound(layouts.begin(), layouts.end(), std::make_pair(type, report_id), [](auto &layout, auto key) {
+                return layout.type != key.first ? layout.type < key.first : layout.report_id < key.second;
+            });
+
+            if (it == layouts.end() || it->type != type || it->report_id != report_id) {
+                return nullptr;
             }
 
-            if (usage_page >= 0xF1D1 || (usage_page >= 0x93 && usage_page < 0xF1D0)) {
-                return { (UsagePage)usage_page, 0x00, 0xFFFF, NULL, "RESERVED" };
+            return &*it;
+        }
+
+        std::map<uint16_t, size_t> Descriptor::report_lengths(MainItemTag type) const {
+            std::map<uint16_t, size_t> lengths;
+
+            for (auto &layout : layouts) {
+                if (layout.type == type) lengths[layout.report_id] = layout.length;
             }
 
-            for (size_t i = 0; i < USAGES_LENGTH; i++) {
-                const UsageDef def = usage_definitions[i];
+            return lengths;
+        }
+
+        size_t Descriptor::max_report_length(MainItemTag type) const {
+            size_t length = 0;
 
-                if (usage_page == def.page && usage_type >= def.min && usage_type <= def.max) {
-                    return def;
+            for (auto [_, bytes] : report_lengths(type)) {
+                if (bytes > length) length = bytes;
+            }
+
+            return length;
+        }
+
+        CollectionGraph collection_graph(const std::vector<Collection> &collections) {
+            // Every collection with a parent is an edge from it, read straight off the list rather than copied out
+            auto has_parent = [&collections](uint32_t i) { return collections[i].parent != NO_COLLECTION; };
+            auto edge = [&collections](uint32_t i) { return std::make_pair(collections[i].parent, i); };
+
+            boost::counting_iterator<uint32_t> first(0), last((uint32_t)collections.size());
+
+            auto edges_begin = boost::make_transform_iterator(boost::make_filter_iterator(has_parent, first, last), edge);
+            auto edges_end = boost::make_transform_iterator(boost::make_filter_iterator(has_parent, last, last), edge);
+
+            uint32_t edge_count = 0, last_parent = 0;
+            bool parents_in_order = true;
+
+            for (auto &collection : collections) {
+                if (collection.parent == NO_COLLECTION) continue;
+
+                parents_in_order &= collection.parent >= last_parent;
+                last_parent = collection.parent;
+                edge_count++;
+            }
+
+            // Simple descriptors nest their collections so their parents already come in order, and
+            // need no sorting; otherwise edges are grouped by parent, keeping their order. Either
+            // way each collection's children stay in descriptor order.
+            CollectionGraph graph = parents_in_order
+                ? CollectionGraph(boost::edges_are_sorted, edges_begin, edges_end, (uint32_t)collections.size(), edge_count)
+                : CollectionGraph(boost::edges_are_unsorted_multi_pass, edges_begin, edges_end, (uint32_t)collections.size());
+
+            for (uint32_t i = 0; i < collections.size(); i++) {
+                graph[i] = collections[i];
+            }
+
+            return graph;
+        }
+
+        const Collection& Descriptor::collection(uint32_t index) const {
+            return collections[index];
+        }
+
+        uint16_t Descriptor::array_usage(const ArrayField &array, uint32_t index) const {
+            if (array.usage_count > 0) {
+                return index < array.usage_count ? array_usages[array.first_usage + index] : 0;
+            }
+
+            return index <= (uint32_t)(array.usage_max - array.usage_min) ? (uint16_t)(array.usage_min + index) : 0;
+        }
+
+        uint32_t Descriptor::find_collection(CollectionType type, uint16_t usage_page, uint16_t usage) const {
+            for (uint32_t i = 0; i < boost::num_vertices(collections); i++) {
+                auto &collection = collections[i];
+
+                if (collection.type == type && collection.usage_page == usage_page && collection.usage == usage) {
+                    return i;
                 }
             }
 
-            return { UNDEFINED, 0x00, 0xFFFF, NULL, "UNDEFINED" };
+            return NO_COLLECTION;
         }
 
-        const char *physical_min(const Node *node) {
+        std::pair<uint32_t, uint32_t> Descriptor::collection_fields(uint32_t collection, MainItemTag type) const {
+            auto &def = collections[collection];
+            size_t slot = type_slot(type);
 
-            return NULL;            
+            return { def.first_field[slot], def.end_field[slot] };
         }
 
-        const char *physical_max(const Node *node) {
-            return NULL;
+        std::vector<FieldHandle> Descriptor::find_fields(uint32_t collection, MainItemTag type, uint16_t usage_page,
+                                                         uint16_t usage_min, uint16_t usage_max) const {
+            auto &table = fields(type);
+            auto [first, end] = collection_fields(collection, type);
+
+            std::vector<FieldHandle> found;
+
+            for (uint32_t row = first; row < end; row++) {
+                if (table.usage_pages[row] == usage_page && table.usages[row] >= usage_min && table.usages[row] <= usage_max) {
+                    found.push_back(table.handle(row));
+                }
+            }
+
+            return found;
+        }
+
+        namespace {
+
+            constexpr bool usage_ranges_valid() {
+                for (auto &def : usage_definitions) {
+                    if (def.min > def.max) return false;
+                }
+
+                return true;
+            }
+
+            constexpr bool usage_ranges_ordered() {
+                for (size_t i = 1; i < std::size(usage_definitions); i++) {
+                    auto &before = usage_definitions[i - 1];
+                    auto &after = usage_definitions[i];
+
+                    if (before.page > after.page || (before.page == after.page && before.max >= after.min)) return false;
+                }
+
+                return true;
+            }
+
+            constexpr bool usage_pages_consistent() {
+                uint32_t next = 0;
+
+                for (size_t i = 0; i < std::size(usage_pages); i++) {
+                    auto &page = usage_pages[i];
+
+                    if (i > 0 && usage_pages[i - 1].page >= page.page) return false;
+                    if (page.first != next) return false;
+
+                    for (uint32_t j = page.first; j < page.first + page.count; j++) {
+                        if (usage_definitions[j].page != page.page) return false;
+                    }
+
+                    next += page.count;
+                }
+
+                return next == std::size(usage_definitions);
+            }
+
+            // The generator checks these too, but the tables are only trusted once the compiler agrees
+            static_assert(usage_ranges_valid(), "usage_definitions has a range which ends before it starts");
+            static_assert(usage_ranges_ordered(), "usage_definitions is out of order, or has ranges which overlap on the same page");
+            static_assert(usage_pages_consistent(), "usage_pages doesn't match usage_definitions");
+
+            constexpr UsageDef vendor_defined = { UNDEFINED, 0x00, 0xFFFF, UCF_NONE, USAGE_NAME_VENDOR_DEFINED };
+            constexpr UsageDef reserved = { UNDEFINED, 0x00, 0xFFFF, UCF_NONE, USAGE_NAME_RESERVED };
+            constexpr UsageDef undefined = { UNDEFINED, 0x00, 0xFFFF, UCF_NONE, USAGE_NAME_UNDEFINED };
+
+            const UsagePageDef* find_usage_page(uint16_t usage_page) {
+                auto it = std::lower_bound(std::begin(usage_pages), std::end(usage_pages), usage_page, [](const UsagePageDef &def, uint16_t page) {
+                    return def.page < page;
+                });
+
+                return it != std::end(usage_pages) && it->page == usage_page ? it : nullptr;
+            }
+        }
+
+        const char *UsageDef::name() const {
+            return usage_strings + name_offset;
+        }
+
+        const UsageDef& find_usage_definition(uint16_t usage_page, uint16_t usage_type) {
+            if (usage_page >= 0xFF00) {
+                return vendor_defined;
+            }
+
+            const UsagePageDef *page = find_usage_page(usage_page);
+
+            if (page == nullptr) {
+                return usage_page == UNDEFINED ? undefined : reserved;
+            }
+
+            // The last range on this page starting at or before the usage is the only one which can hold it.
+            const UsageDef *first = usage_definitions + page->first;
+            const UsageDef *last = first + page->count;
+            auto it = std::upper_bound(first, last, usage_type, [](uint16_t usage, const UsageDef &def) {
+                return usage < def.min;
+            });
+
+            if (it != first && usage_type <= (it - 1)->max) {
+                return *(it - 1);
+            }
+
+            return page->complete ? reserved : undefined;
+        }
+
+        const char *usage_page_name(uint16_t usage_page) {
+            if (usage_page >= 0xFF00) {
+                return usage_strings + USAGE_NAME_VENDOR_DEFINED;
+            }
+
+            const UsagePageDef *page = find_usage_page(usage_page);
+
+            if (page == nullptr) {
+                return usage_strings + (usage_page == UNDEFINED ? USAGE_NAME_UNDEFINED : USAGE_NAME_RESERVED);
+            }
+
+            return usage_strings + page->name_offset;
+        }
+
+        static std::string physical_value(const Node *node, int32_t value) {
+            std::string unit = Unit(node->unit, node->unit_exp).to_string();
+
+            // Without a unit the exponent isn't part of the name, so it's shown on the value
+            if (unit.empty() && node->unit_exp != 0) return fmt::format("{}e{}", value, node->unit_exp);
+
+            return unit.empty() ? fmt::format("{}", value) : fmt::format("{} {}", value, unit);
+        }
+
+        // A field without a physical range (both ends 0) uses its logical one
+        static bool has_physical_range(const Node *node) {
+            return node->physical_min != 0 || node->physical_max != 0;
+        }
+
+        std::string physical_min(const Node *node) {
+            return physical_value(node, has_physical_range(node) ? node->physical_min : node->min_value);
+        }
+
+        std::string physical_max(const Node *node) {
+            return physical_value(node, has_physical_range(node) ? node->physical_max : node->max_value);
         }
     }
 }
-
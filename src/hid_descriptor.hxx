@@ -1,12 +1,21 @@
 #pragma once
 
+#include <array>
+#include <bitset>
+#include <iterator>
 #include <vector>
 #include <map>
 #include <stdint.h>
+#include <string.h>
+#include <string>
 
 #include <boost/config.hpp>
+#include <boost/graph/compressed_sparse_row_graph.hpp>
 #include <boost/graph/graph_traits.hpp>
 
+#include "bits.hxx"
+#include "unit.hxx"
+
 #define GET_LOGICAL_MINIMUM(X) (HID::ReportItemTag::GLOBAL_ITEM | 1<<4U | (uint8_t)(X) & SIZE_MASK)
 
 namespace HID {
@@ -66,15 +75,40 @@ namespace HID {
         const UsageControlFlags UCF_US = 1 << 14;   // Usage Switch
         const UsageControlFlags UCF_UM = 1 << 15;   // Usage Modifier
 
+        /**
+         * A range of usages on one page which share a definition.
+         *
+         * The definitions are generated from `data/hid_usage_tables.txt` at build time,
+         * with the names kept in a single string pool.
+         */
         typedef struct UsageDef {
-            UsagePage page;
+            uint16_t page;
             uint16_t min;
             uint16_t max;
             UsageControlFlags control_type;
-            char name[36];
-            // const char *name;
+
+            // Offset of the name in the string pool
+            uint32_t name_offset;
+
+            const char *name() const;
         } UsageDef;
 
+        /**
+         * A usage page, and where its usage definitions are.
+         */
+        typedef struct UsagePageDef {
+            uint16_t page;
+
+            // Whether every usage on the page is defined, so any which aren't are reserved
+            bool complete;
+
+            uint32_t name_offset;
+
+            // Index of the page's first usage definition, and how many it has
+            uint32_t first;
+            uint32_t count;
+        } UsagePageDef;
+
         typedef enum ReportItemType {
             MAIN_ITEM = 0,
             GLOBAL_ITEM = 4,
@@ -158,6 +192,45 @@ namespace HID {
             BufferedBytes = 1 << 8
         };
 
+        // Collection index of fields (and collections) which aren't inside one
+        const uint32_t NO_COLLECTION = UINT32_MAX;
+
+        /**
+         * A single collection, and the fields inside it.
+         *
+         * Every field inside a collection (nested ones included) comes between its
+         * start and its end in the descriptor, so for each report type those fields
+         * are one run of rows in that type's `FieldTable`.
+         */
+        typedef struct Collection {
+            // Vendor-defined types (0x80 and up) are kept as they are
+            CollectionType type;
+
+            uint16_t usage_page;
+            uint16_t usage;
+
+            // Index of the collection this one is in, or `NO_COLLECTION`
+            uint32_t parent;
+
+            // Rows of the fields inside, by report type slot (see `FieldHandle::slot`), as [first, end)
+            std::array<uint32_t, 3> first_field;
+            std::array<uint32_t, 3> end_field;
+        } Collection;
+
+        /**
+         * Every collection in the descriptor, as vertices numbered in the order they
+         * start, with an edge from each collection to each one directly inside it.
+         *
+         * Stored as a compressed sparse row graph, since it's built in one go once
+         * the whole descriptor has been read and never changes after.
+         */
+        typedef boost::compressed_sparse_row_graph<boost::directedS, Collection, boost::no_property, boost::no_property, uint32_t, uint32_t> CollectionGraph;
+
+        /**
+         * Build the graph of these collections, linking each to its `parent`, which must come before it.
+         */
+        CollectionGraph collection_graph(const std::vector<Collection> &collections);
+
         typedef struct Node {
             UsagePage usage_page;
             uint16_t report_id;
@@ -177,247 +250,468 @@ namespace HID {
 
             int32_t physical_min;
             int32_t physical_max;
-            uint8_t unit_exp;
+
+            // The UNIT item as given, and the decoded UNIT_EXPONENT (see `Unit`)
+            uint32_t unit;
+            int8_t unit_exp;
+
+            // Index of the innermost collection the field is in, or `NO_COLLECTION`
+            uint32_t collection;
+
+            // The data bits of the main item which declared the field (see `InputProperty` and `OutputProperty`)
+            uint16_t flags;
         } Node;
 
+        /**
+         * Where the fields of one report live.
+         *
+         * Field bit offsets (`Node::report_index`) count from the start of the
+         * report's data, after its report ID byte if it has one.
+         */
+        typedef struct ReportLayout {
+            MainItemTag type;
+            uint8_t report_id;
+
+            // Length of the whole report in bytes, including its report ID
+            size_t length;
+
+            // The report's fields are `field_count` entries of `Descriptor::layout_fields` from `first_field`
+            uint32_t first_field;
+            uint32_t field_count;
+        } ReportLayout;
+
+        /**
+         * A main item without the Variable bit: `count` slots of `size` bits, each holding
+         * the index of a control which is on (a key which is held, say), counted from
+         * `logical_min`. Slots left over when fewer controls are on hold a value outside
+         * the logical range.
+         *
+         * Each slot is also a field of its own in the node list and field table.
+         */
+        typedef struct ArrayField {
+            MainItemTag type;
+            uint8_t report_id;
+
+            // Bit offset of the first slot within the report's data, and the size of each
+            uint32_t offset;
+            uint8_t size;
+            uint32_t count;
+
+            int32_t logical_min;
+            int32_t logical_max;
+
+            uint16_t usage_page;
+
+            // Controls' usages, either from a usage range...
+            uint16_t usage_min;
+            uint16_t usage_max;
+
+            // ...or, when `usage_count` isn't 0, listed one by one in `Descriptor::array_usages`
+            uint32_t first_usage;
+            uint32_t usage_count;
+
+            // Row of the first slot in the field table for `type`
+            uint32_t first_field;
+        } ArrayField;
+
+        /**
+         * Refers to a single field: the type of report it's in and its row in that type's `FieldTable`.
+         */
+        class FieldHandle {
+            public:
+                FieldHandle() = default;
+
+                constexpr FieldHandle(uint8_t slot, uint32_t row) : value((uint32_t)slot << 30 | (row & ROW_MASK)) {}
+
+                // 0 for inputs, 1 for outputs, 2 for features
+                constexpr uint8_t slot() const { return value >> 30; }
+                constexpr uint32_t row() const { return value & ROW_MASK; }
+
+                constexpr bool operator==(const FieldHandle&) const = default;
+
+            private:
+                static const uint32_t ROW_MASK = (1u << 30) - 1;
+
+                uint32_t value;
+        };
+
+        /**
+         * How a field's logical values map to physical ones: `logical * scale + bias`.
+         */
+        typedef struct PhysicalTransform {
+            float scale;
+            float bias;
+        } PhysicalTransform;
+
+        /**
+         * Every field of one report type, stored column by column.
+         *
+         * Row `i` of each column describes the same field as node `i` of the matching
+         * node list, so loops over many fields only pull in the columns they use.
+         * Anything only needed now and then, like a field's unit or physical range, is left on its node.
+         */
+        typedef struct FieldTable {
+            MainItemTag type;
+
+            std::vector<uint8_t> report_ids;
+
+            // Bit offset within the report's data, and size in bits
+            std::vector<uint32_t> offsets;
+            std::vector<uint8_t> sizes;
+
+            std::vector<uint16_t> usage_pages;
+            std::vector<uint16_t> usages;
+
+            std::vector<int32_t> logical_mins;
+            std::vector<int32_t> logical_maxs;
+
+            // Logical to physical values, in the field's unit including its exponent: see `physical`
+            std::vector<PhysicalTransform> transforms;
+
+            // Innermost collection of each field
+            std::vector<uint32_t> collections;
+
+            size_t size() const { return offsets.size(); }
+
+            /**
+             * A logical value of the field in `row`, in physical units.
+             *
+             * Fields without a physical range come out as their logical value, times
+             * their unit exponent's power of ten.
+             */
+            float physical(uint32_t row, int32_t logical) const {
+                return (float)logical * transforms[row].scale + transforms[row].bias;
+            }
+
+            FieldHandle handle(uint32_t row) const;
+        } FieldTable;
+
         class Descriptor {
             public:
                 std::vector<Node> inputs;
                 std::vector<Node> outputs;
                 std::vector<Node> features;
+
+                // The same fields as the node lists, as columns
+                FieldTable input_fields;
+                FieldTable output_fields;
+                FieldTable feature_fields;
+
+                // One layout per report, ordered by type then report ID
+                std::vector<ReportLayout> layouts;
+
+                // Every layout's fields, as indices into the node list for its type in bit offset order
+                std::vector<uint32_t> layout_fields;
+
+                CollectionGraph collections;
+
+                // Every array main item, in the order they were declared
+                std::vector<ArrayField> arrays;
+
+                // Usages of array items which list them rather than giving a range
+                std::vector<uint16_t> array_usages;
+
+                /**
+                 * The nodes of the given report type.
+                 */
+                const std::vector<Node>& nodes(MainItemTag type) const;
+
+                /**
+                 * The field table of the given report type.
+                 */
+                const FieldTable& fields(MainItemTag type) const;
+                const FieldTable& fields(FieldHandle field) const;
+
+                /**
+                 * The layout of a single report, or null if the descriptor doesn't declare it.
+                 */
+                const ReportLayout* layout(MainItemTag type, uint8_t report_id) const;
+
+                /**
+                 * The length in bytes of each report of the given type, by report ID,
+                 * including the report ID itself.
+                 */
+                std::map<uint16_t, size_t> report_lengths(MainItemTag type) const;
+
+                /**
+                 * The length in bytes of the longest report of the given type,
+                 * including its report ID. 0 if there are no reports of that type.
+                 */
+                size_t max_report_length(MainItemTag type) const;
+
+                const Collection& collection(uint32_t index) const;
+
+                /**
+                 * The usage of the control at `index` in an array, or 0 if the array has no control there.
+                 */
+                uint16_t array_usage(const ArrayField &array, uint32_t index) const;
+
+                /**
+                 * The first collection of this type and usage, or `NO_COLLECTION` if there isn't one.
+                 */
+                uint32_t find_collection(CollectionType type, uint16_t usage_page, uint16_t usage) const;
+
+                /**
+                 * The fields of the given report type inside a collection, nested ones included,
+                 * as a range of rows [first, end) of that type's field table.
+                 */
+                std::pair<uint32_t, uint32_t> collection_fields(uint32_t collection, MainItemTag type) const;
+
+                /**
+                 * The fields of the given report type inside a collection, nested ones included,
+                 * whose usage is on `usage_page` between `usage_min` and `usage_max`.
+                 *
+                 * Only the collection's own rows are looked at, so callers can find the
+                 * fields they want once and keep the handles rather than walking the tree again.
+                 */
+                std::vector<FieldHandle> find_fields(uint32_t collection, MainItemTag type, uint16_t usage_page,
+                                                     uint16_t usage_min, uint16_t usage_max) const;
         };
 
-        Descriptor parse(const unsigned char *buffer, size_t buffer_sz);
+        // Prefix of a long item, which carries its own data size and tag in the two bytes after it
+        const uint8_t LONG_ITEM_PREFIX = 0xFE;
+
+        /**
+         * A single short item, as it appears in the descriptor.
+         */
+        typedef struct Item {
+            ReportItemType type;
+            uint8_t tag;
+
+            // Size of the item's data in bytes: 0, 1, 2 or 4
+            uint8_t size;
+
+            // The data zero extended, as most items take it
+            uint32_t data;
+
+            // The data sign extended, for the items which are signed (logical and physical extents, unit exponent)
+            int32_t signed_data;
+
+            // Where the item starts in the descriptor
+            uint32_t offset;
+        } Item;
+
+        /**
+         * The items of a report descriptor, read one at a time as they're asked for.
+         *
+         *     for (auto &item : Items(buffer, buffer_sz)) { ... }
+         *
+         * Nothing is built or allocated, so a loop which stops early only pays for the
+         * items it looked at. A truncated descriptor ends at its last complete item,
+         * and long items (which no HID usage defines) are skipped.
+         */
+        class Items {
+            public:
+                class iterator {
+                    public:
+                        using value_type = Item;
+                        using difference_type = std::ptrdiff_t;
+
+                        iterator() = default;
+                        iterator(const unsigned char *buffer, size_t length) : buffer(buffer), length(length) { advance(); }
+
+                        const Item& operator*() const { return item; }
+                        const Item* operator->() const { return &item; }
+
+                        iterator& operator++() { advance(); return *this; }
+                        void operator++(int) { advance(); }
+
+                        bool operator==(std::default_sentinel_t) const { return done; }
+
+                    private:
+                        const unsigned char *buffer = nullptr;
+                        size_t length = 0;
+                        size_t position = 0;
+
+                        Item item = {};
+                        bool done = true;
+
+                        void advance();
+                };
+
+                Items(const unsigned char *buffer, size_t length) : buffer(buffer), length(length) {}
+
+                iterator begin() const { return iterator(buffer, length); }
+                std::default_sentinel_t end() const { return std::default_sentinel; }
+
+            private:
+                const unsigned char *buffer;
+                size_t length;
+        };
+
+        inline void Items::iterator::advance() {
+            while (position < length) {
+                uint8_t prefix = buffer[position];
+
+                if (prefix == LONG_ITEM_PREFIX) {
+                    if (position + 3 > length) break;
+
+                    position += 3 + buffer[position + 1];
+                    continue;
+                }
 
-        UsageDef find_usage_definition(uint16_t usage_page, uint16_t usage_id);
+                uint8_t size = (prefix & SIZE_MASK) == 3 ? 4 : (prefix & SIZE_MASK);
+                if (position + 1 + size > length) break;
 
-        const char *physical_min(const Node *node);
-        const char *physical_max(const Node *node);
+                const unsigned char *data = buffer + position + 1;
+
+                item.type = (ReportItemType)(prefix & TYPE_MASK);
+                item.tag = prefix >> 4;
+                item.size = size;
+                item.offset = (uint32_t)position;
+
+                // Given the rest of the descriptor, the data can be read as one word; its size still ends it at the item
+                item.data = (uint32_t)extract_bits(data, length - position - 1, 0, size * 8, false);
+                item.signed_data = extract_bits(data, length - position - 1, 0, size * 8, true);
+
+                position += 1 + size;
+                done = false;
+                return;
+            }
+
+            done = true;
+        }
+
+        static_assert(std::input_iterator<Items::iterator>);
+
+        // Deepest PUSH nesting kept; pushes beyond it are ignored along with their POPs
+        const size_t MAX_GLOBAL_DEPTH = 16;
+
+        // Deepest collection nesting kept; fields in collections beyond it belong to the deepest one kept
+        const size_t MAX_COLLECTION_DEPTH = 32;
+
+        // Every local item takes at least a byte, so a maximum-size descriptor can't hold more
+        const size_t MAX_LOCAL_ITEMS = 4096;
 
         /**
-         * A big list of all the usage definition ranges
-        */
-        const UsageDef usage_definitions[] = {
-            // Generic
-            {GENERIC, 0x01, 0x01, UCF_CP, "Pointer"},
-            {GENERIC, 0x02, 0x02, UCF_CA, "Mouse"},
-            {GENERIC, 0x03, 0x03, UCF_NONE, "RESERVED"},
-            {GENERIC, 0x04, 0x04, UCF_CA, "Joystick"},
-            {GENERIC, 0x05, 0x05, UCF_CA, "Gamepad"},
-            {GENERIC, 0x06, 0x06, UCF_CA, "Keyboard"},
-            {GENERIC, 0x07, 0x07, UCF_CA, "Keypad"},
-            {GENERIC, 0x08, 0x08, UCF_CA, "Multi-Axis Controller"},
-            {GENERIC, 0x09, 0x09, UCF_CA, "Tablet PC Controls"},
-            {GENERIC, 0x0A, 0x0A, UCF_CA, "Water Cooling Device"},
-            {GENERIC, 0x0B, 0x0B, UCF_CA, "Computer Chassis Device"},
-            {GENERIC, 0x0C, 0x0C, UCF_CA, "Wireless Radio Controls"},
-            {GENERIC, 0x0D, 0x0D, UCF_CA, "Portable Device Controls"},
-            {GENERIC, 0x0E, 0x0E, UCF_CA, "System Multi-Controller"},
-            {GENERIC, 0x0F, 0x0F, UCF_CA, "Spatial Controller"},
-            {GENERIC, 0x10, 0x10, UCF_CA, "Assistive Control"},
-            {GENERIC, 0x11, 0x11, UCF_CA, "Device Dock"},
-            {GENERIC, 0x13, 0x2F, UCF_NONE, "RESERVED"},
-            {GENERIC, 0x30, 0x30, UCF_DV, "X"},
-            {GENERIC, 0x31, 0x31, UCF_DV, "Y"},
-            {GENERIC, 0x32, 0x32, UCF_DV, "Z"},
-            {GENERIC, 0x33, 0x33, UCF_DV, "Rx"},
-            {GENERIC, 0x34, 0x34, UCF_DV, "Ry"},
-            {GENERIC, 0x35, 0x35, UCF_DV, "Rz"},
-            {GENERIC, 0x36, 0x36, UCF_DV, "Slider"},
-            {GENERIC, 0x37, 0x37, UCF_DV, "Dial"},
-            {GENERIC, 0x38, 0x38, UCF_DV, "Wheel"},
-            {GENERIC, 0x39, 0x39, UCF_DV, "Hat Switch"},
-            {GENERIC, 0x3a, 0x3a, UCF_CL, "Counted Buffer"},
-            {GENERIC, 0x3b, 0x3b, UCF_DV, "Byte Count"},
-            {GENERIC, 0x3c, 0x3c, UCF_OSC | UCF_DF, "Motion Wakeup"},
-            {GENERIC, 0x3d, 0x3d, UCF_OOC, "Start "},
-            {GENERIC, 0x3e, 0x3e, UCF_OOC, "Select"},
-            {GENERIC, 0x3f, 0x3f, NULL, "RESERVED"},
-            {GENERIC, 0x40, 0x40, UCF_DV, "Vx"},
-            {GENERIC, 0x41, 0x41, UCF_DV, "Vy"},
-            {GENERIC, 0x42, 0x42, UCF_DV, "Vz"},
-            {GENERIC, 0x43, 0x43, UCF_DV, "Vbrx"},
-            {GENERIC, 0x44, 0x44, UCF_DV, "Vbry"},
-            {GENERIC, 0x45, 0x45, UCF_DV, "Vbrz"},
-            {GENERIC, 0x46, 0x46, UCF_DV, "Vno"},
-            {GENERIC, 0x47, 0x47, UCF_DV | UCF_DF, "Feature Notification"},
-            {GENERIC, 0x48, 0x48, UCF_DV, "Resolution Multiplier"},
-            /* TODO: 0x49 - 0x93 */
-            {GENERIC, 0x94, 0x94, UCF_MC | UCF_DV, "Index Trigger"},
-            {GENERIC, 0x95, 0x95, UCF_MC | UCF_DV, "Palm Trigger"},
-            /* TODO: 0x96 ~ 0xD6 */
-            {GENERIC, 0xD7, 0xFFFF, NULL, "RESERVED" },
-
-            // VR Controls
-            {VIRTUAL_REALITY, 0x01, 0x01, UCF_CA, "Belt" },
-            {VIRTUAL_REALITY, 0x02, 0x02, UCF_CA, "Body Suit" },
-            {VIRTUAL_REALITY, 0x03, 0x03, UCF_CP, "Flexor" },
-            {VIRTUAL_REALITY, 0x04, 0x04, UCF_CA, "Glove" },
-            {VIRTUAL_REALITY, 0x05, 0x05, UCF_CP, "Head Tracker" },
-            {VIRTUAL_REALITY, 0x06, 0x06, UCF_CA, "Head Mounted Display" },
-            {VIRTUAL_REALITY, 0x07, 0x07, UCF_CA, "Hand Tracker" },
-            {VIRTUAL_REALITY, 0x08, 0x08, UCF_CA, "Oculometer" },
-            {VIRTUAL_REALITY, 0x09, 0x09, UCF_CA, "Vest" },
-            {VIRTUAL_REALITY, 0x0A, 0x0A, UCF_CA, "Animatronic Device" },
-            {VIRTUAL_REALITY, 0x0B, 0x1F, NULL, "RESERVED" },
-            {VIRTUAL_REALITY, 0x20, 0x20, UCF_OOC, "Stereo Enable" },
-            {VIRTUAL_REALITY, 0x21, 0x21, UCF_OOC, "Display Enable" },
-            {VIRTUAL_REALITY, 0x00, 0xFFFF, NULL, "RESERVED" },
-
-            // Game Controls
-            {GAME_CONTROLS, 0x01, 0x01, UCF_CA, "3D Game Controller"},
-            {GAME_CONTROLS, 0x02, 0x02, UCF_CA, "Pinball Device"},
-            {GAME_CONTROLS, 0x03, 0x03, UCF_CA, "Gun Device"},
-            {GAME_CONTROLS, 0x04, 0x1F, NULL, "RESERVED"},
-            {GAME_CONTROLS, 0x20, 0x20, UCF_CP, "Point of View"},
-            {GAME_CONTROLS, 0x21, 0x21, UCF_DV, "Turn Right/Left"},
-            {GAME_CONTROLS, 0x22, 0x22, UCF_DV, "Pitch Forward/Backward"},
-            {GAME_CONTROLS, 0x23, 0x23, UCF_DV, "Roll Right/Left"},
-            {GAME_CONTROLS, 0x24, 0x24, UCF_DV, "Move Right/Left"},
-            {GAME_CONTROLS, 0x25, 0x25, UCF_DV, "Move Forward/Backward"},
-            {GAME_CONTROLS, 0x26, 0x26, UCF_DV, "Move Up/Down"},
-            {GAME_CONTROLS, 0x27, 0x27, UCF_DV, "Lean Left/Right"},
-            {GAME_CONTROLS, 0x28, 0x28, UCF_DV, "Lean Forward/Backward"},
-            {GAME_CONTROLS, 0x29, 0x29, UCF_DV, "Height of POV"},
-            {GAME_CONTROLS, 0x2A, 0x2A, UCF_MC, "Flipper"},
-            {GAME_CONTROLS, 0x2B, 0x2B, UCF_MC, "Secondary Flipper"},
-            {GAME_CONTROLS, 0x2C, 0x2C, UCF_MC, "Bump"},
-            {GAME_CONTROLS, 0x2D, 0x2D, UCF_OSC, "New Game"},
-            {GAME_CONTROLS, 0x2E, 0x2E, UCF_OSC, "Shoot Ball"},
-            {GAME_CONTROLS, 0x2F, 0x2F, UCF_OSC, "Player"},
-
-            // Buttons -- They're all just... buttons.
-            {BUTTON, 0x00, 0xFFFF, UCF_Sel | UCF_OOC | UCF_MC | UCF_OSC, "Button" },
-
-            // Ordinals
-            {ORDINAL, 0x00, 0xFFFF, UCF_UM, "Ordinal Instance"},
-
-            // Consumer Devices
-            {CONSUMER, 0x01, 0x01, UCF_CA, "Consumer Control" },
-            {CONSUMER, 0x02, 0x02, UCF_NAry, "Numeric Key Pad" },
-            {CONSUMER, 0x03, 0x03, UCF_NAry, "Programmable Buttons" },
-            {CONSUMER, 0x04, 0x04, UCF_CA, "Microphone" },
-            {CONSUMER, 0x05, 0x05, UCF_CA, "Headphone" },
-            {CONSUMER, 0x06, 0x06, UCF_CA, "Graphic Equalizer" },
-            {CONSUMER, 0x07, 0x1F, UCF_NONE, "RESERVED" },
-
-            // PID (Physical Interface Device)
-            {PID, 0x01, 0x01, UCF_CA, "Physical Interface Device"},
-            {PID, 0x02, 0x1F, NULL, "RESERVED"},
-            {PID, 0x20, 0x20, UCF_DV, "Normal" },
-            {PID, 0x21, 0x21, UCF_CA, "Set Effect Report" },
-            {PID, 0x22, 0x22, UCF_DV, "Effect Block Index" },
-            {PID, 0x23, 0x23, UCF_DV, "Parameter Block Offset" },
-            {PID, 0x24, 0x24, UCF_DV, "ROM Flag" },
-            {PID, 0x25, 0x25, UCF_CA, "Effect Type" },
-            {PID, 0x26, 0x26, UCF_DV, "ET Constant Force" },
-            {PID, 0x27, 0x27, UCF_DV, "ET Ramp" },
-            {PID, 0x28, 0x28, UCF_DV, "ET Custom Force Data" },
-            {PID, 0x29, 0x2F, NULL, "RESERVED" },
-            {PID, 0x30, 0x30, UCF_DV, "ET Square" },
-            {PID, 0x31, 0x31, UCF_DV, "ET Sine" },
-            {PID, 0x32, 0x32, UCF_DV, "ET Triangle" },
-            {PID, 0x33, 0x33, UCF_DV, "ET Sawtooth Up" },
-            {PID, 0x34, 0x34, UCF_DV, "ET Sawtooth Down" },
-            {PID, 0x35, 0x3F, NULL, "RESERVED" },
-            {PID, 0x40, 0x40, UCF_DV, "ET Spring" },
-            {PID, 0x41, 0x41, UCF_DV, "ET Damper" },
-            {PID, 0x42, 0x42, UCF_DV, "ET Inertia" },
-            {PID, 0x43, 0x43, UCF_DV, "ET Friction" },
-            {PID, 0x44, 0x4F, NULL, "RESERVED" },
-            {PID, 0x50, 0x50, UCF_DV, "Duration" },
-            {PID, 0x51, 0x51, UCF_DV, "Sample Period" },
-            {PID, 0x52, 0x52, UCF_DV, "Gain" },
-            {PID, 0x53, 0x53, UCF_DV, "Trigger Button" },
-            {PID, 0x54, 0x54, UCF_DV, "Trigger Repeat Interval" },
-            {PID, 0x55, 0x55, UCF_CA, "Axes Enable" },
-            {PID, 0x56, 0x56, UCF_DV, "Direction Enable" },
-            {PID, 0x57, 0x57, UCF_CA, "Direction" },
-            {PID, 0x58, 0x58, UCF_CA, "Type Specific Block Offset" },
-            {PID, 0x59, 0x59, UCF_CA, "Block Type" },
-            {PID, 0x5A, 0x5A, UCF_CA, "Set Envelope Report" },
-            {PID, 0x5B, 0x5B, UCF_DV, "Attack Level" },
-            {PID, 0x5C, 0x5C, UCF_DV, "Attack Time" },
-            {PID, 0x5D, 0x5D, UCF_DV, "Fade Level" },
-            {PID, 0x5E, 0x5E, UCF_DV, "Fade Time" },
-            {PID, 0x5F, 0x5F, UCF_CA, "Set Condition Report" },
-            {PID, 0x60, 0x60, UCF_DV, "CP Offset" },
-            {PID, 0x61, 0x61, UCF_DV, "Positive Coefficient" },
-            {PID, 0x62, 0x62, UCF_DV, "Negative Coefficient" },
-            {PID, 0x63, 0x63, UCF_DV, "Positive Saturation" },
-            {PID, 0x64, 0x63, UCF_DV, "Negative Saturation" },
-            {PID, 0x65, 0x65, UCF_DV, "Dead Band" },
-            {PID, 0x66, 0x66, UCF_CA, "Download Force Sample" },
-            {PID, 0x67, 0x67, UCF_DV, "Isoch Custom Force Enable" },
-            {PID, 0x68, 0x68, UCF_CA, "Custom Force Data Report" },
-            {PID, 0x69, 0x69, UCF_DV, "Custom Force Data" },
-            {PID, 0x6A, 0x6A, UCF_DV, "Custom Force Vendor Defined Data"},
-            {PID, 0x6B, 0x6B, UCF_CA, "Set Custom Force Report" },
-            {PID, 0x6C, 0x6C, UCF_DV, "Custom Force Data Offset" },
-            {PID, 0x6D, 0x6D, UCF_DV, "Sample Count" },
-            {PID, 0x6E, 0x6E, UCF_CA, "Set Periodic Report" },
-            {PID, 0x6F, 0x6F, UCF_DV, "Offset" },
-            {PID, 0x70, 0x70, UCF_DV, "Magnitude" },
-            {PID, 0x71, 0x71, UCF_DV, "Phase" },
-            {PID, 0x72, 0x72, UCF_DV, "Period" },
-            {PID, 0x73, 0x73, UCF_CA, "Set Constant Force Report" },
-            {PID, 0x74, 0x74, UCF_CA, "Set Ramp Force Report" },
-            {PID, 0x75, 0x75, UCF_DV, "Ramp Start" },
-            {PID, 0x76, 0x76, UCF_DV, "Ramp End" },
-            {PID, 0x77, 0x77, UCF_CA, "Effect Operation Report" },
-            {PID, 0x78, 0x78, UCF_CA, "Effect Operation" },
-            {PID, 0x79, 0x79, UCF_DV, "Op Effect Start" },
-            {PID, 0x7A, 0x7A, UCF_DV, "Op Effect Solo" },
-            {PID, 0x7B, 0x7B, UCF_DV, "Op Effect Stop" },
-            {PID, 0x7C, 0x7C, UCF_DV, "Loop Count" },
-            {PID, 0x7D, 0x7D, UCF_CA, "Device Gain Report" },
-            {PID, 0x7E, 0x7E, UCF_DV, "Device Gain" },
-            {PID, 0x7F, 0x7F, UCF_CA, "PID Pool Report" },
-            {PID, 0x80, 0x80, UCF_DV, "RAM Pool Size" },
-            {PID, 0x81, 0x81, UCF_DV, "ROM Pool Size" },
-            {PID, 0x82, 0x82, UCF_DV, "ROM Effect Block Size" },
-            {PID, 0x83, 0x83, UCF_DV, "Simultaneous Effects Max" },
-            {PID, 0x84, 0x84, UCF_DV, "Pool Alignment" },
-            {PID, 0x85, 0x85, UCF_CA, "PID Pool Move Report" },
-            {PID, 0x86, 0x86, UCF_DV, "Move Source" },
-            {PID, 0x87, 0x87, UCF_DV, "Move Destination" },
-            {PID, 0x88, 0x88, UCF_DV, "Move Length" },
-            {PID, 0x89, 0x89, UCF_CA, "PID Block Load Report" },
-            {PID, 0x8A, 0x8A, NULL, "RESERVED" },
-            {PID, 0x8B, 0x8B, UCF_CA, "Block Load Status" },
-            {PID, 0x8C, 0x8C, UCF_DV, "Block Load Success" },
-            {PID, 0x8D, 0x8D, UCF_DV, "Block Load Full" },
-            {PID, 0x8E, 0x8E, UCF_DV, "Block Load Error" },
-            {PID, 0x8F, 0x8F, UCF_DV, "Block Handle" },
-            {PID, 0x90, 0x90, UCF_CA, "PID Block Free Report" },
-            {PID, 0x91, 0x91, UCF_CA, "Type Specific Block Handle" },
-            {PID, 0x92, 0x92, UCF_CA, "PID State Report" },
-            {PID, 0x93, 0x93, NULL, "RESERVED" },
-            {PID, 0x94, 0x94, UCF_DV, "Effect Playing" },
-            {PID, 0x95, 0x95, UCF_CA, "PID Device Control Report" },
-            {PID, 0x96, 0x96, UCF_CA, "PID Device Control" },
-            {PID, 0x97, 0x97, UCF_DV, "DC Enable Actuators" },
-            {PID, 0x98, 0x98, UCF_DV, "DC Disable Actuators" },
-            {PID, 0x99, 0x99, UCF_DV, "DC Stop All Effects" },
-            {PID, 0x9A, 0x9A, UCF_DV, "DC Device Reset" },
-            {PID, 0x9B, 0x9B, UCF_DV, "DC Device Pause" },
-            {PID, 0x9C, 0x9C, UCF_DV, "DC Device Continue" },
-            {PID, 0x9D, 0x9E, NULL, "RESERVED" },
-            {PID, 0x9F, 0x9F, UCF_DV, "Device Paused" },
-            {PID, 0xA0, 0xA0, UCF_DV, "Actuators Enabled" },
-            {PID, 0xA1, 0xA3, NULL, "RESERVED" },
-            {PID, 0xA4, 0xA4, UCF_DV, "Safety Switch" },
-            {PID, 0xA5, 0xA5, UCF_DV, "Actuator Override Switch" },
-            {PID, 0xA6, 0xA6, UCF_DV, "Actuator Power" },
-            {PID, 0xA7, 0xA7, UCF_DV, "Start Delay" },
-            {PID, 0xA8, 0xA8, UCF_CA, "Parameter Block Size" },
-            {PID, 0xA9, 0xA9, UCF_DV, "Device Managed Pool" },
-            {PID, 0xAA, 0xAA, UCF_DV, "Shared Parameter Blocks" },
-            {PID, 0xAB, 0xAB, UCF_CA, "Create New Effect Report" },
-            {PID, 0xAC, 0xAC, UCF_DV, "RAM Pool Available" },
-            {PID, 0xAB, 0xFFFF, NULL, "RESERVED"}
+         * Turns a report descriptor into a `Descriptor`.
+         *
+         * A parser keeps all of its working state (the running bit offset, the global
+         * item stack and the pending local items) to itself, so separate parsers can
+         * run on different threads at once. A single parser is not thread safe, but
+         * can be reused for one descriptor after another.
+         *
+         * That state lives in fixed-capacity arrays (and lists of the nodes, arrays and
+         * collections found so far, which keep their capacity from one descriptor to
+         * the next), so parsing allocates nothing beyond the tables of the `Descriptor`
+         * it returns, each of which is allocated once at its final size.
+         */
+        class Parser {
+            public:
+                Descriptor parse(const unsigned char *buffer, size_t buffer_sz);
+
+            private:
+                using GlobalParams = std::array<int32_t, 10>;
+
+                // Global state values which can be changed by a GLOBAL item.
+                // These can be stacked... because of course..
+                std::array<GlobalParams, MAX_GLOBAL_DEPTH> globals;
+                size_t global_depth;
+
+                // PUSHes which didn't fit in `globals`, so their POPs can be ignored too
+                size_t global_overflow;
+
+                /**
+                 * Local items seen since the last main item, in the order they came.
+                 *
+                 * Each kind of local item is consumed first-in first-out; `local_next`
+                 * holds how far through the list each kind has got.
+                 */
+                std::array<int32_t, MAX_LOCAL_ITEMS> local_values;
+                std::array<LocalItemTag, MAX_LOCAL_ITEMS> local_tags;
+                size_t local_count;
+                std::array<uint16_t, 16> local_next;
+
+                // Bit offset of the next field in each report, by report type (see `type_slot`) and report ID
+                std::array<std::array<uint32_t, 256>, 3> report_bits;
+
+                // Fields in each report, by report type and report ID
+                std::array<std::array<uint32_t, 256>, 3> report_fields;
+
+                // Report IDs each report type has used, in the order they came. Only these
+                // IDs' entries above belong to the current descriptor, so nothing has to
+                // clear the rest before the next one.
+                std::array<std::array<uint8_t, 256>, 3> report_order;
+                std::array<size_t, 3> report_order_length;
+                std::array<std::bitset<256>, 3> reports_used;
+
+                // Every node so far, by report type, which become the descriptor's node lists at the end
+                std::array<std::vector<Node>, 3> node_lists;
+
+                // Every array so far, and their listed usages, which become `descriptor.arrays` and `descriptor.array_usages`
+                std::vector<ArrayField> array_list;
+                std::vector<uint16_t> array_usage_list;
+
+                // Every collection so far, which becomes `descriptor.collections` at the end
+                std::vector<Collection> collection_list;
+
+                // Collections the next item is inside, innermost last
+                std::array<uint32_t, MAX_COLLECTION_DEPTH> collection_stack;
+                size_t collection_depth;
+
+                // Collections which didn't fit in `collection_stack`, so their ends can be ignored too
+                size_t collection_overflow;
+
+                void main_item(uint8_t tag, uint8_t data_sz, int32_t data);
+                void global_item(const Item &item);
+                void local_item(uint8_t tag, int32_t data);
+                void node(uint8_t data_sz, int32_t data, MainItemTag type);
+                void start_collection(int32_t data);
+                void end_collection();
+
+                void clear_locals();
+
+                // Fill in the descriptor's layouts and field tables once every node is known
+                void build_layouts(Descriptor &descriptor);
+                void build_fields(Descriptor &descriptor);
+
+                // Whether a local item of this kind is still waiting to be used
+                bool has_local(LocalItemTag tag);
+
+                // Take the oldest unused local item of this kind, which must exist
+                int32_t take_local(LocalItemTag tag);
         };
 
-        const size_t USAGES_LENGTH = sizeof(usage_definitions) / sizeof(UsageDef);
+        /**
+         * Parse a report descriptor with a parser of its own. Safe to call from any thread.
+         *
+         * The parser lives on the stack for just this call (about 30 KB, mostly pending
+         * local items), and its lists start empty. Code parsing many descriptors in a
+         * row should keep a `Parser` of its own, whose lists keep their capacity.
+         */
+        Descriptor parse(const unsigned char *buffer, size_t buffer_sz);
+
+        /**
+         * The report IDs the descriptor declares, in ascending order. Empty if its reports aren't numbered.
+         */
+        std::vector<uint8_t> report_ids(const unsigned char *buffer, size_t buffer_sz);
+
+        /**
+         * The usage of the descriptor's first application collection, with its page in the
+         * high 16 bits (0x00010004 for a joystick). 0 if it doesn't have one.
+         */
+        uint32_t application_usage(const unsigned char *buffer, size_t buffer_sz);
+
+        /**
+         * Whether the descriptor uses the Physical Input Device page, i.e. the device has force feedback.
+         */
+        bool is_pid_device(const unsigned char *buffer, size_t buffer_sz);
+
+        /**
+         * Look up the definition of a usage. Usages without one get a shared "UNDEFINED",
+         * "RESERVED" or "Vendor-Defined" definition, which covers the whole page.
+         */
+        const UsageDef& find_usage_definition(uint16_t usage_page, uint16_t usage_id);
+
+        /**
+         * Get the name of a usage page, or "RESERVED" / "Vendor-Defined" for pages without one.
+         */
+        const char *usage_page_name(uint16_t usage_page);
+
+        /**
+         * The ends of a field's physical range with its unit, such as "-900 10^-1 deg".
+         */
+        std::string physical_min(const Node *node);
+        std::string physical_max(const Node *node);
     }
 }
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include "histogram.hxx"
+
+#include <bit>
+#include <math.h>
+
+namespace HID {
+
+    // Standard USB polling rates, in Hz
+    const double POLLING_RATES[] = { 125, 250, 500, 1000, 2000, 4000, 8000 };
+
+    // How close a measured rate must be to a standard one to be snapped to it
+    const double POLLING_RATE_TOLERANCE = 0.1;
+
+    Histogram::Histogram() {
+        clear();
+        reset_requested = false;
+    }
+
+    size_t Histogram::bucket_index(uint64_t value) {
+        if (value < SUB_BUCKETS) return (size_t)value;
+
+        uint32_t magnitude = 63 - std::countl_zero(value);
+        if (magnitude >= MAX_MAGNITUDE) return BUCKETS - 1;
+
+        // Shift the value down to its top 7 bits, which lie in [64, 128)
+        uint32_t shift = magnitude - 6;
+        return SUB_BUCKETS + (shift - 1) * (SUB_BUCKETS / 2) + (size_t)((value >> shift) - SUB_BUCKETS / 2);
+    }
+
+    uint64_t Histogram::bucket_limit(size_t index) {
+        if (index < SUB_BUCKETS) return index;
+        if (index >= BUCKETS - 1) return UINT64_MAX;
+
+        uint32_t shift = (uint32_t)((index - SUB_BUCKETS) / (SUB_BUCKETS / 2)) + 1;
+        uint64_t top = (index - SUB_BUCKETS) % (SUB_BUCKETS / 2) + SUB_BUCKETS / 2;
+
+        return ((top + 1) << shift) - 1;
+    }
+
+    void Histogram::record(uint64_t value) {
+        if (reset_requested.load(std::memory_order_relaxed)) {
+            clear();
+            reset_requested.store(false, std::memory_order_relaxed);
+        }
+
+        // Single writer, so plain load/store pairs are enough and avoid locked instructions.
+        auto &bucket = buckets[bucket_index(value)];
+        bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+        sum.store(sum.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        if (value < min.load(std::memory_order_relaxed)) min.store(value, std::memory_order_relaxed);
+        if (value > max.load(std::memory_order_relaxed)) max.store(value, std::memory_order_relaxed);
+
+        count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    void Histogram::reset() {
+        reset_requested.store(true, std::memory_order_relaxed);
+    }
+
+    void Histogram::clear() {
+        for (auto &bucket : buckets) bucket.store(0, std::memory_order_relaxed);
+
+        count.store(0, std::memory_order_relaxed);
+        sum.store(0, std::memory_order_relaxed);
+        min.store(UINT64_MAX, std::memory_order_relaxed);
+        max.store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t Histogram::percentile(double percentile) const {
+        uint64_t total = 0;
+
+        // Sum the buckets rather than trusting `count`, which may be ahead of them while recording.
+        for (auto &bucket : buckets) total += bucket.load(std::memory_order_relaxed);
+        if (total == 0) return 0;
+
+        uint64_t target = (uint64_t)ceil(total * percentile / 100.0);
+        if (target < 1) target = 1;
+
+        uint64_t seen = 0, limit = max.load(std::memory_order_relaxed);
+
+        for (size_t i = 0; i < BUCKETS; i++) {
+            seen += buckets[i].load(std::memory_order_relaxed);
+
+            if (seen >= target) {
+                uint64_t value = bucket_limit(i);
+                return value < limit ? value : limit;
+            }
+        }
+
+        return limit;
+    }
+
+    IntervalStats Histogram::summary() const {
+        IntervalStats stats = {};
+
+        stats.count = count.load(std::memory_order_acquire);
+        if (stats.count == 0) return stats;
+
+        stats.min = min.load(std::memory_order_relaxed);
+        stats.max = max.load(std::memory_order_relaxed);
+        stats.mean = (double)sum.load(std::memory_order_relaxed) / stats.count;
+
+        stats.p50 = percentile(50);
+        stats.p99 = percentile(99);
+        stats.p999 = percentile(99.9);
+
+        if (stats.p50 > 0) {
+            stats.polling_rate = 1e9 / stats.p50;
+
+            for (double rate : POLLING_RATES) {
+                if (fabs(stats.polling_rate - rate) <= rate * POLLING_RATE_TOLERANCE) {
+                    stats.polling_rate = rate;
+                    break;
+                }
+            }
+        }
+
+        return stats;
+    }
+
+}
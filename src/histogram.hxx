@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+
+#include <stdint.h>
+
+namespace HID {
+
+    /**
+     * Summary of a `Histogram` of report intervals, in nanoseconds.
+     */
+    typedef struct {
+        uint64_t count;
+
+        uint64_t min;
+        uint64_t p50;
+        uint64_t p99;
+        uint64_t p999;
+        uint64_t max;
+        double mean;
+
+        // Polling rate in Hz implied by the median interval, snapped to a standard USB rate when close to one
+        double polling_rate;
+    } IntervalStats;
+
+    /**
+     * A high dynamic range histogram of nanosecond intervals.
+     *
+     * Values are bucketed log-linearly: exact below `SUB_BUCKETS`, then 64 buckets
+     * per power of two, which keeps every bucket within 1.6% of the values in it
+     * from 1 ns up to ~68 s. Larger values land in the last bucket, but `max` is
+     * still exact.
+     *
+     * `record` is a handful of relaxed loads and stores, cheap enough for the
+     * capture path. It must only be called by one thread at a time; readers can
+     * summarize the histogram concurrently.
+     */
+    class Histogram {
+        public:
+            // Exact buckets below this, and twice the number of buckets per power of two above it
+            static const uint64_t SUB_BUCKETS = 128;
+
+            // Values at or above 2^MAX_MAGNITUDE all fall into the last bucket
+            static const uint32_t MAX_MAGNITUDE = 36;
+
+            // The exact buckets, those of each power of two up to MAX_MAGNITUDE, and the overflow bucket
+            static const size_t BUCKETS = SUB_BUCKETS + (MAX_MAGNITUDE - 7) * (SUB_BUCKETS / 2) + 1;
+
+            Histogram();
+
+            /**
+             * Add a value. Must only be called from the capture thread.
+             */
+            void record(uint64_t value);
+
+            /**
+             * Ask the capture thread to clear the histogram before its next `record`.
+             */
+            void reset();
+
+            IntervalStats summary() const;
+
+            /**
+             * Value at or below which `percentile` (0 - 100) of the recorded values fall.
+             */
+            uint64_t percentile(double percentile) const;
+
+            static size_t bucket_index(uint64_t value);
+
+            /**
+             * The largest value which lands in the given bucket.
+             */
+            static uint64_t bucket_limit(size_t index);
+
+        private:
+            std::atomic<uint32_t> buckets[BUCKETS];
+
+            std::atomic<uint64_t> count;
+            std::atomic<uint64_t> sum;
+            std::atomic<uint64_t> min;
+            std::atomic<uint64_t> max;
+
+            std::atomic<bool> reset_requested;
+
+            void clear();
+    };
+
+}
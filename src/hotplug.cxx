@@ -0,0 +1,211 @@
+#include "hotplug.hxx"
+
+#include <algorithm>
+
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+
+#if __linux__
+    #include <poll.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+    #include <linux/netlink.h>
+#endif
+
+namespace HID {
+
+    // How long the monitor sleeps between checks for events and stop requests
+    const auto HOTPLUG_POLL = std::chrono::milliseconds(250);
+
+    // Time for a device node to settle after its uevent before enumerating it
+    const auto HOTPLUG_SETTLE = std::chrono::milliseconds(100);
+
+    std::shared_timed_mutex enumeration_lock;
+
+    static wchar_t* copy_wstring(const wchar_t *value) {
+        if (value == nullptr) return nullptr;
+
+        size_t length = wcslen(value) + 1;
+        wchar_t *copy = (wchar_t*)malloc(length * sizeof(wchar_t));
+        memcpy(copy, value, length * sizeof(wchar_t));
+
+        return copy;
+    }
+
+    hid_device_info* copy_device_info(const hid_device_info *device) {
+        hid_device_info *copy = (hid_device_info*)malloc(sizeof(hid_device_info));
+
+        memcpy(copy, device, sizeof(hid_device_info));
+        copy->path = device->path ? strdup(device->path) : nullptr;
+        copy->serial_number = copy_wstring(device->serial_number);
+        copy->manufacturer_string = copy_wstring(device->manufacturer_string);
+        copy->product_string = copy_wstring(device->product_string);
+        copy->next = nullptr;
+
+        return copy;
+    }
+
+    void free_device_info(hid_device_info *device) {
+        if (device == nullptr) return;
+
+        free(device->path);
+        free(device->serial_number);
+        free(device->manufacturer_string);
+        free(device->product_string);
+        free(device);
+    }
+
+    HotplugMonitor::HotplugMonitor() : running(false), rescan_requested(false), uevents(-1) {}
+
+    HotplugMonitor::~HotplugMonitor() {
+        stop();
+
+        for (auto device : pending.added) free_device_info(device);
+    }
+
+    void HotplugMonitor::start(const std::vector<std::string> &known) {
+        this->known = std::set<std::string>(known.begin(), known.end());
+
+#if __linux__
+        uevents = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_KOBJECT_UEVENT);
+
+        if (uevents >= 0) {
+            sockaddr_nl address = {};
+            address.nl_family = AF_NETLINK;
+            address.nl_groups = 1; // Kernel uevents
+
+            if (bind(uevents, (sockaddr*)&address, sizeof(address)) != 0) {
+                close(uevents);
+                uevents = -1;
+            }
+        }
+#endif
+
+        running = true;
+        thread = std::thread(&HotplugMonitor::run, this);
+    }
+
+    void HotplugMonitor::stop() {
+        running = false;
+        if (thread.joinable()) thread.join();
+
+#if __linux__
+        if (uevents >= 0) close(uevents);
+#endif
+        uevents = -1;
+    }
+
+    void HotplugMonitor::rescan() {
+        rescan_requested = true;
+    }
+
+    bool HotplugMonitor::take_changes(DeviceChanges &changes) {
+        std::lock_guard<std::mutex> guard(lock);
+
+        if (pending.added.empty() && pending.removed.empty()) return false;
+
+        changes.added.insert(changes.added.end(), pending.added.begin(), pending.added.end());
+        changes.removed.insert(changes.removed.end(), pending.removed.begin(), pending.removed.end());
+        pending = {};
+
+        return true;
+    }
+
+    void HotplugMonitor::run() {
+        while (wait()) {
+            scan();
+        }
+    }
+
+    bool HotplugMonitor::wait() {
+        auto deadline = std::chrono::steady_clock::now() + HOTPLUG_INTERVAL;
+
+        while (running) {
+            if (rescan_requested.exchange(false)) return true;
+
+#if __linux__
+            if (uevents >= 0) {
+                pollfd pfd = { uevents, POLLIN, 0 };
+                bool changed = false;
+
+                if (poll(&pfd, 1, (int)HOTPLUG_POLL.count()) > 0) {
+                    char message[4096];
+                    ssize_t n;
+
+                    // Messages are NUL-separated KEY=VALUE pairs; only hidraw nodes matter to us.
+                    while ((n = recv(uevents, message, sizeof(message) - 1, 0)) > 0) {
+                        message[n] = 0;
+
+                        for (char *field = message; field < message + n; field += strlen(field) + 1) {
+                            if (strcmp(field, "SUBSYSTEM=hidraw") == 0 || strcmp(field, "SUBSYSTEM=hid") == 0) changed = true;
+                        }
+                    }
+                }
+
+                if (changed) {
+                    std::this_thread::sleep_for(HOTPLUG_SETTLE);
+                    return running;
+                }
+
+                continue;
+            }
+#endif
+
+            std::this_thread::sleep_for(HOTPLUG_POLL);
+            if (std::chrono::steady_clock::now() >= deadline) return true;
+        }
+
+        return false;
+    }
+
+    void HotplugMonitor::scan() {
+        std::unique_lock<std::shared_timed_mutex> enumerating(enumeration_lock, HOTPLUG_INTERVAL);
+
+        // A device which hangs while it's being opened mustn't stall the monitor, so try again later
+        if (!enumerating.owns_lock()) {
+            rescan_requested = true;
+            return;
+        }
+
+        hid_device_info *devices = hid_enumerate(0x00, 0x00);
+        enumerating.unlock();
+
+        std::set<std::string> present;
+        DeviceChanges changes;
+
+        for (auto device = devices; device; device = device->next) {
+            if (device->path == nullptr) continue;
+
+            present.insert(device->path);
+            if (!known.contains(device->path)) changes.added.push_back(copy_device_info(device));
+        }
+
+        hid_free_enumeration(devices);
+
+        for (auto &path : known) {
+            if (!present.contains(path)) changes.removed.push_back(path);
+        }
+
+        known = std::move(present);
+
+        if (changes.added.empty() && changes.removed.empty()) return;
+
+        std::lock_guard<std::mutex> guard(lock);
+
+        for (auto &path : changes.removed) {
+            // A device which came and went before anyone noticed doesn't need to be opened at all.
+            auto added = std::find_if(pending.added.begin(), pending.added.end(), [&](hid_device_info *d) { return path == d->path; });
+
+            if (added != pending.added.end()) {
+                free_device_info(*added);
+                pending.added.erase(added);
+            } else {
+                pending.removed.push_back(path);
+            }
+        }
+
+        pending.added.insert(pending.added.end(), changes.added.begin(), changes.added.end());
+    }
+
+}
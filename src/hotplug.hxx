@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <hidapi.h>
+
+namespace HID {
+
+    // How often to re-enumerate when the platform can't notify us of changes
+    const auto HOTPLUG_INTERVAL = std::chrono::seconds(2);
+
+    /**
+     * Devices which appeared or disappeared since the last `HotplugMonitor::take_changes`.
+     */
+    typedef struct {
+        // Copies of the new devices' info, owned by the receiver (free with `free_device_info`)
+        std::vector<hid_device_info*> added;
+
+        // Paths of devices which have gone
+        std::vector<std::string> removed;
+    } DeviceChanges;
+
+    /**
+     * Held exclusively around `hid_enumerate`, and shared while opening a device and fetching its descriptor.
+     *
+     * hidapi doesn't promise that enumerating is safe while another thread opens a device
+     * (on Linux both walk udev and sysfs), so the two take turns. Opens still overlap each
+     * other. Reads, writes and `hid_close` only touch the device's own handle, which hidapi
+     * allows from different threads for different devices, so they don't take it.
+     */
+    extern std::shared_timed_mutex enumeration_lock;
+
+    /**
+     * Copy a single `hid_device_info`, without its `next` link.
+     */
+    hid_device_info* copy_device_info(const hid_device_info *device);
+    void free_device_info(hid_device_info *device);
+
+    /**
+     * Watches for HID interfaces being added and removed.
+     *
+     * On Linux the monitor listens for hidraw uevents on a netlink socket and
+     * re-enumerates when one arrives. Elsewhere it re-enumerates every
+     * `HOTPLUG_INTERVAL`. Either way it diffs the enumeration by path against
+     * the devices it already knows about and queues up the differences, which
+     * the owner applies from its own thread with `take_changes`.
+     */
+    class HotplugMonitor {
+        public:
+            HotplugMonitor();
+            ~HotplugMonitor();
+
+            /**
+             * Start watching, treating the devices at `known` as already present.
+             */
+            void start(const std::vector<std::string> &known);
+            void stop();
+
+            /**
+             * Re-enumerate as soon as possible, e.g. after a device returned a read error.
+             */
+            void rescan();
+
+            /**
+             * Move every queued change into `changes`.
+             *
+             * Removals are meant to be applied before additions, so a device which was
+             * unplugged and plugged back in is closed and then reopened.
+             * Returns false if nothing changed.
+             */
+            bool take_changes(DeviceChanges &changes);
+
+        private:
+            std::thread thread;
+            std::atomic<bool> running;
+            std::atomic<bool> rescan_requested;
+
+            // Netlink uevent socket, or -1 when falling back to periodic enumeration
+            int uevents;
+
+            // Paths present at the last enumeration (monitor thread only)
+            std::set<std::string> known;
+
+            std::mutex lock;
+            DeviceChanges pending;
+
+            void run();
+
+            /**
+             * Wait until an enumeration is due. Returns false if the monitor is stopping.
+             */
+            bool wait();
+
+            void scan();
+    };
+
+}
@@ -0,0 +1,304 @@
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+
+#include "clock.hxx"
+#include "hotplug.hxx"
+#include "opener.hxx"
+
+namespace HID {
+
+    struct OpenThreads {
+        std::mutex lock;
+        std::condition_variable exited_changed;
+
+        // Every thread started and not joined yet
+        std::vector<std::thread> running;
+
+        // Threads in `running` which have returned, and can be joined without waiting
+        std::vector<std::thread::id> exited;
+
+        // Set by `Opener::stop`; any thread started after it is detached straight away
+        bool stopped = false;
+
+        uint64_t next_id = 0;
+        std::vector<std::pair<uint64_t, OpenResult>> results;
+    };
+
+    namespace {
+
+        // Times to ask for a device's report descriptor before giving up on it
+        const int DESCRIPTOR_ATTEMPTS = 2;
+
+        typedef struct {
+            std::string path;
+            OpenResult result;
+
+            // When a thread picked the job up, or 0 while it's still queued
+            uint64_t started;
+            bool done;
+            bool abandoned;
+        } OpenJob;
+
+        /**
+         * State shared between the caller and the open threads.
+         *
+         * Threads hold a reference so anything left running after a timeout still has somewhere to write.
+         */
+        typedef struct {
+            std::mutex lock;
+            std::condition_variable changed;
+            std::vector<OpenJob> jobs;
+            size_t next;
+        } OpenBatch;
+
+        /**
+         * Join the threads which have already returned. `workers.lock` must be held.
+         */
+        void reap(OpenThreads &workers) {
+            for (auto id : workers.exited) {
+                for (auto it = workers.running.begin(); it != workers.running.end(); it++) {
+                    if (it->get_id() != id) continue;
+
+                    it->join();
+                    workers.running.erase(it);
+                    break;
+                }
+            }
+
+            workers.exited.clear();
+        }
+
+        /**
+         * Run `fn` on a thread of its own, tracked by `workers`.
+         */
+        template <typename F>
+        void spawn(const std::shared_ptr<OpenThreads> &workers, F &&fn) {
+            std::lock_guard<std::mutex> guard(workers->lock);
+            reap(*workers);
+
+            // The thread can't report itself as exited before it's in `running`, since that takes the lock held here
+            std::thread thread([workers, fn = std::forward<F>(fn)]() mutable {
+                fn();
+
+                std::lock_guard<std::mutex> guard(workers->lock);
+                if (workers->stopped) return;
+
+                workers->exited.push_back(std::this_thread::get_id());
+                workers->exited_changed.notify_all();
+            });
+
+            if (workers->stopped) {
+                thread.detach();
+            } else {
+                workers->running.push_back(std::move(thread));
+            }
+        }
+
+        void open_worker(std::shared_ptr<OpenBatch> batch) {
+            std::unique_lock<std::mutex> guard(batch->lock);
+
+            while (batch->next < batch->jobs.size()) {
+                size_t index = batch->next++;
+                std::string path = batch->jobs[index].path;
+                uint64_t started = Clock::now();
+                batch->jobs[index].started = started;
+
+                // Let the caller know there's a new deadline to watch
+                batch->changed.notify_all();
+                guard.unlock();
+
+                // Kept until the descriptor has been fetched, so the hotplug monitor doesn't enumerate meanwhile
+                std::shared_lock<std::shared_timed_mutex> opening(enumeration_lock);
+
+                OpenResult result = {};
+                result.status = OpenStatus::Failed;
+                result.device = hid_open_path(path.c_str());
+
+                uint64_t opened = Clock::now();
+                result.open_ns = opened - started;
+
+                if (result.device) {
+                    hid_set_nonblocking(result.device, 1);
+
+                    int length = 0;
+
+                    for (int attempt = 0; attempt < DESCRIPTOR_ATTEMPTS && length <= 0; attempt++) {
+                        length = hid_get_report_descriptor(result.device, result.descriptor, sizeof(result.descriptor));
+                    }
+
+                    result.describe_ns = Clock::now() - opened;
+
+                    // Without a descriptor there is nothing to decode its reports with
+                    if (length > 0) {
+                        result.descriptor_length = length;
+                        result.status = OpenStatus::Opened;
+                    } else {
+                        hid_close(result.device);
+                        result.device = nullptr;
+                    }
+                }
+
+                opening.unlock();
+                guard.lock();
+
+                OpenJob &job = batch->jobs[index];
+
+                // Nobody is waiting for this one any more, so don't leak its handle.
+                if (job.abandoned) {
+                    if (result.device) hid_close(result.device);
+                    continue;
+                }
+
+                job.result = result;
+                job.done = true;
+                batch->changed.notify_all();
+            }
+        }
+
+        std::vector<OpenResult> open_all(const std::shared_ptr<OpenThreads> &workers, const std::vector<std::string> &paths, size_t threads, std::chrono::nanoseconds timeout) {
+            auto batch = std::make_shared<OpenBatch>();
+            batch->next = 0;
+            batch->jobs.resize(paths.size());
+
+            for (size_t i = 0; i < paths.size(); i++) {
+                batch->jobs[i].path = paths[i];
+            }
+
+            threads = std::max<size_t>(std::min(threads, paths.size()), 1);
+
+            for (size_t i = 0; i < threads; i++) {
+                spawn(workers, [batch]() { open_worker(batch); });
+            }
+
+            const uint64_t limit = timeout.count();
+            std::unique_lock<std::mutex> guard(batch->lock);
+
+            for (;;) {
+                uint64_t now = Clock::now();
+                uint64_t deadline = UINT64_MAX;
+                bool pending = false;
+
+                for (auto &job : batch->jobs) {
+                    if (job.done || job.abandoned) continue;
+
+                    if (job.started == 0) {
+                        pending = true;
+                        continue;
+                    }
+
+                    if (now - job.started < limit) {
+                        pending = true;
+                        deadline = std::min(deadline, job.started + limit);
+                        continue;
+                    }
+
+                    // Leave the stuck thread to it and replace it, so the queue keeps moving.
+                    job.abandoned = true;
+                    job.result = {};
+                    job.result.status = OpenStatus::TimedOut;
+                    job.result.open_ns = now - job.started;
+
+                    if (batch->next < batch->jobs.size()) {
+                        spawn(workers, [batch]() { open_worker(batch); });
+                    }
+                }
+
+                if (!pending) break;
+
+                if (deadline == UINT64_MAX) {
+                    batch->changed.wait(guard);
+                } else {
+                    batch->changed.wait_for(guard, std::chrono::nanoseconds(deadline - now));
+                }
+            }
+
+            std::vector<OpenResult> results;
+            results.reserve(paths.size());
+
+            for (auto &job : batch->jobs) {
+                results.push_back(job.result);
+            }
+
+            return results;
+        }
+    }
+
+    Opener::Opener() : workers(std::make_shared<OpenThreads>()) {}
+
+    Opener::~Opener() {
+        stop();
+    }
+
+    std::vector<OpenResult> Opener::open(const std::vector<std::string> &paths, size_t threads, std::chrono::nanoseconds timeout) {
+        return open_all(workers, paths, threads, timeout);
+    }
+
+    uint64_t Opener::open_async(const std::string &path) {
+        uint64_t id;
+
+        {
+            std::lock_guard<std::mutex> guard(workers->lock);
+            id = workers->next_id++;
+        }
+
+        spawn(workers, [workers = workers, id, path]() {
+            auto results = open_all(workers, { path }, 1, OPEN_TIMEOUT);
+
+            std::lock_guard<std::mutex> guard(workers->lock);
+
+            // Nobody will take it any more, so don't leak its handle
+            if (workers->stopped) {
+                if (results[0].device) hid_close(results[0].device);
+                return;
+            }
+
+            workers->results.emplace_back(id, results[0]);
+        });
+
+        return id;
+    }
+
+    bool Opener::take_results(std::vector<std::pair<uint64_t, OpenResult>> &results) {
+        std::lock_guard<std::mutex> guard(workers->lock);
+
+        if (workers->results.empty()) return false;
+
+        for (auto &result : workers->results) {
+            results.push_back(result);
+        }
+
+        workers->results.clear();
+
+        return true;
+    }
+
+    bool Opener::stop(std::chrono::nanoseconds timeout) {
+        std::unique_lock<std::mutex> guard(workers->lock);
+
+        bool idle = workers->exited_changed.wait_for(guard, timeout, [this]() {
+            return workers->exited.size() == workers->running.size();
+        });
+
+        reap(*workers);
+
+        // Nothing can interrupt hidapi, so whatever is still stuck in it is left to finish on its own
+        for (auto &thread : workers->running) {
+            thread.detach();
+        }
+
+        workers->running.clear();
+        workers->stopped = true;
+
+        // Results nobody took, which would otherwise leak their handles
+        for (auto &[_, result] : workers->results) {
+            if (result.device) hid_close(result.device);
+        }
+
+        workers->results.clear();
+
+        return idle;
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <hidapi.h>
+
+namespace HID {
+
+    // Upper bound on threads opening devices at once
+    const size_t DEFAULT_OPEN_THREADS = 8;
+
+    // How long a single device may take to open and describe before we give up on it
+    const auto OPEN_TIMEOUT = std::chrono::seconds(3);
+
+    enum class OpenStatus : uint8_t {
+        Opened,
+
+        // The device couldn't be opened, or wouldn't give its report descriptor
+        Failed,
+
+        // Still hadn't finished after `OPEN_TIMEOUT`; the handle is closed if it ever opens
+        TimedOut,
+    };
+
+    /**
+     * The outcome of opening and describing a single device.
+     */
+    typedef struct OpenResult {
+        OpenStatus status;
+
+        // Non-blocking handle, null unless `Opened`
+        hid_device *device;
+
+        int descriptor_length;
+        unsigned char descriptor[HID_API_MAX_REPORT_DESCRIPTOR_SIZE];
+
+        // Time spent in `hid_open_path` and `hid_get_report_descriptor`
+        uint64_t open_ns;
+        uint64_t describe_ns;
+    } OpenResult;
+
+    // Threads started by an `Opener`, and the results of its background opens (see opener.cxx)
+    struct OpenThreads;
+
+    /**
+     * Opens devices and fetches their report descriptors on threads of its own.
+     *
+     * Every thread it starts is tracked, including any left behind by a device which
+     * hung, so that they can all be waited for before hidapi is shut down.
+     */
+    class Opener {
+        public:
+            Opener();
+            Opener(const Opener&) = delete;
+            Opener& operator=(const Opener&) = delete;
+
+            ~Opener();
+
+            /**
+             * Open every device in `paths` and fetch its report descriptor, spread across up to `threads` threads.
+             *
+             * Results are in the same order as `paths`. A device which hangs is reported as
+             * `TimedOut` once it has been at it for `timeout`, and its thread is left behind
+             * to finish (or not) on its own while a fresh one takes over the rest of the queue,
+             * so one bad device never holds up the others.
+             */
+            std::vector<OpenResult> open(const std::vector<std::string> &paths,
+                size_t threads = DEFAULT_OPEN_THREADS,
+                std::chrono::nanoseconds timeout = OPEN_TIMEOUT);
+
+            /**
+             * Start opening the device at `path` in the background, and return an ID for its result.
+             *
+             * The result is handed out by `take_results` once it's ready, at most `OPEN_TIMEOUT` later.
+             */
+            uint64_t open_async(const std::string &path);
+
+            /**
+             * Move the results of every background open which has finished since the last call
+             * into `results`, by the ID `open_async` returned. Returns false if none have.
+             */
+            bool take_results(std::vector<std::pair<uint64_t, OpenResult>> &results);
+
+            /**
+             * Wait up to `timeout` for every thread to finish, and join them.
+             *
+             * Returns false if some are still stuck in hidapi after that. They're left to
+             * finish on their own, and hidapi mustn't be shut down under them.
+             */
+            bool stop(std::chrono::nanoseconds timeout = OPEN_TIMEOUT);
+
+        private:
+            // Shared with the threads, so any still stuck after `stop` have somewhere to finish
+            std::shared_ptr<OpenThreads> workers;
+    };
+}
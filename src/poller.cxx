@@ -0,0 +1,336 @@
+#include "poller.hxx"
+#include "hid.hxx"
+
+#include <string.h>
+
+#if __linux__
+    #include <errno.h>
+    #include <fcntl.h>
+    #include <sys/epoll.h>
+    #include <unistd.h>
+#elif _WIN32
+    #include <algorithm>
+    #include <array>
+    #include <atomic>
+
+    #define NOMINMAX
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+    #include <hidsdi.h>
+#endif
+
+namespace HID {
+
+#if __linux__
+
+    // Number of events to collect from a single `epoll_wait`
+    const int MAX_EVENTS = 64;
+
+    Poller::Poller() {
+        handle = epoll_create1(EPOLL_CLOEXEC);
+    }
+
+    Poller::~Poller() {
+        if (handle >= 0) ::close(handle);
+    }
+
+    bool Poller::supported() {
+        return true;
+    }
+
+    int Poller::open(const char *path) {
+        // Only the hidraw backend hands out device node paths we can open ourselves.
+        if (path == nullptr || strncmp(path, "/dev/hidraw", 11) != 0) return -1;
+
+        return ::open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    }
+
+    void Poller::close(int fd) {
+        if (fd >= 0) ::close(fd);
+    }
+
+    int Poller::read(int fd, unsigned char *buffer, size_t length) {
+        ssize_t n = ::read(fd, buffer, length);
+
+        if (n < 0) {
+            return (errno == EAGAIN || errno == EINTR) ? 0 : -1;
+        }
+
+        return (int)n;
+    }
+
+    bool Poller::add(DeviceInfo *device) {
+        if (handle < 0 || device->fd < 0) return false;
+
+        epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.ptr = device;
+
+        return epoll_ctl(handle, EPOLL_CTL_ADD, device->fd, &ev) == 0;
+    }
+
+    void Poller::remove(DeviceInfo *device) {
+        if (handle < 0 || device->fd < 0) return;
+
+        epoll_ctl(handle, EPOLL_CTL_DEL, device->fd, nullptr);
+    }
+
+    size_t Poller::wait(std::vector<DeviceInfo*> &ready, std::chrono::milliseconds timeout) {
+        epoll_event events[MAX_EVENTS];
+        ready.clear();
+
+        int n = epoll_wait(handle, events, MAX_EVENTS, (int)timeout.count());
+
+        for (int i = 0; i < n; i++) {
+            ready.push_back((DeviceInfo*)events[i].data.ptr);
+        }
+
+        return ready.size();
+    }
+
+#elif _WIN32
+
+    namespace {
+
+        // Most handles open through `Poller::open` at once
+        const int MAX_HANDLES = 256;
+
+        /**
+         * A device handle which always has one overlapped read in flight, so its
+         * event is signalled as soon as a report arrives.
+         */
+        struct Reader {
+            HANDLE file;
+            OVERLAPPED overlapped;
+
+            // Windows hands out exactly one report per read when the buffer is one report long
+            std::vector<unsigned char> buffer;
+
+            // Set when a read couldn't be started, so the next one reports the error
+            bool failed;
+        };
+
+        std::array<std::atomic<Reader*>, MAX_HANDLES> readers;
+
+        Reader* find_reader(int fd) {
+            return fd >= 0 && fd < MAX_HANDLES ? readers[fd].load(std::memory_order_acquire) : nullptr;
+        }
+
+        void start_read(Reader *reader) {
+            if (ReadFile(reader->file, reader->buffer.data(), (DWORD)reader->buffer.size(), nullptr, &reader->overlapped)
+                || GetLastError() == ERROR_IO_PENDING) {
+                return;
+            }
+
+            // Wake whoever waits on the device, so the failure is seen by its next read
+            reader->failed = true;
+            SetEvent(reader->overlapped.hEvent);
+        }
+    }
+
+    Poller::Poller() : handle(-1) {
+        wake = CreateEventA(nullptr, FALSE, FALSE, nullptr);
+    }
+
+    Poller::~Poller() {
+        for (auto &[_, event] : events) CloseHandle(event);
+        for (auto event : retired) CloseHandle(event);
+
+        if (wake) CloseHandle(wake);
+    }
+
+    bool Poller::supported() {
+        return true;
+    }
+
+    int Poller::open(const char *path) {
+        if (path == nullptr) return -1;
+
+        HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_FLAG_OVERLAPPED, nullptr);
+
+        // Keyboards and mice can't be opened for reading; they stay on the polling tick
+        if (file == INVALID_HANDLE_VALUE) return -1;
+
+        PHIDP_PREPARSED_DATA preparsed;
+        HIDP_CAPS caps = {};
+
+        if (!HidD_GetPreparsedData(file, &preparsed)) {
+            CloseHandle(file);
+            return -1;
+        }
+
+        NTSTATUS status = HidP_GetCaps(preparsed, &caps);
+        HidD_FreePreparsedData(preparsed);
+
+        if (status != HIDP_STATUS_SUCCESS || caps.InputReportByteLength == 0) {
+            CloseHandle(file);
+            return -1;
+        }
+
+        // Match the queue depth hidapi asks for, which `OS_QUEUE_DEPTH` assumes
+        HidD_SetNumInputBuffers(file, (ULONG)OS_QUEUE_DEPTH);
+
+        Reader *reader = new Reader{};
+        reader->file = file;
+        reader->buffer.resize(caps.InputReportByteLength);
+        reader->overlapped.hEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+
+        for (int fd = 0; fd < MAX_HANDLES && reader->overlapped.hEvent; fd++) {
+            Reader *empty = nullptr;
+
+            if (readers[fd].compare_exchange_strong(empty, reader, std::memory_order_acq_rel)) {
+                start_read(reader);
+                return fd;
+            }
+        }
+
+        if (reader->overlapped.hEvent) CloseHandle(reader->overlapped.hEvent);
+        CloseHandle(file);
+        delete reader;
+
+        return -1;
+    }
+
+    void Poller::close(int fd) {
+        if (fd < 0 || fd >= MAX_HANDLES) return;
+
+        Reader *reader = readers[fd].exchange(nullptr, std::memory_order_acq_rel);
+        if (reader == nullptr) return;
+
+        // The read in flight writes into the reader, so it has to finish before the reader goes
+        DWORD length;
+        CancelIoEx(reader->file, &reader->overlapped);
+        if (!reader->failed) GetOverlappedResult(reader->file, &reader->overlapped, &length, TRUE);
+
+        CloseHandle(reader->overlapped.hEvent);
+        CloseHandle(reader->file);
+        delete reader;
+    }
+
+    int Poller::read(int fd, unsigned char *buffer, size_t length) {
+        Reader *reader = find_reader(fd);
+        if (reader == nullptr || reader->failed) return -1;
+
+        DWORD n = 0;
+
+        if (!GetOverlappedResult(reader->file, &reader->overlapped, &n, FALSE)) {
+            if (GetLastError() == ERROR_IO_INCOMPLETE) return 0;
+
+            reader->failed = true;
+            return -1;
+        }
+
+        // Reports always start with their ID on Windows; as hidapi does, drop it when the device doesn't use IDs
+        const unsigned char *data = reader->buffer.data();
+
+        if (n > 0 && data[0] == 0) {
+            data++;
+            n--;
+        }
+
+        size_t copied = std::min<size_t>(n, length);
+        memcpy(buffer, data, copied);
+
+        start_read(reader);
+
+        return (int)copied;
+    }
+
+    bool Poller::add(DeviceInfo *device) {
+        Reader *reader = find_reader(device->fd);
+        if (reader == nullptr || wake == nullptr) return false;
+
+        // The poller keeps its own handle to the event, so the device can be closed while a wait is using it
+        HANDLE process = GetCurrentProcess(), event;
+        if (!DuplicateHandle(process, reader->overlapped.hEvent, process, &event, 0, FALSE, DUPLICATE_SAME_ACCESS)) return false;
+
+        std::lock_guard<std::mutex> guard(lock);
+
+        // One wait slot goes to `wake`
+        if (events.size() + 1 >= MAXIMUM_WAIT_OBJECTS) {
+            CloseHandle(event);
+            return false;
+        }
+
+        events.emplace_back(device, event);
+        SetEvent(wake);
+
+        return true;
+    }
+
+    void Poller::remove(DeviceInfo *device) {
+        std::lock_guard<std::mutex> guard(lock);
+
+        auto it = std::find_if(events.begin(), events.end(), [device](auto &entry) { return entry.first == device; });
+        if (it == events.end()) return;
+
+        // A wait may still be using the event, so it's closed by the next one
+        retired.push_back(it->second);
+        events.erase(it);
+
+        SetEvent(wake);
+    }
+
+    size_t Poller::wait(std::vector<DeviceInfo*> &ready, std::chrono::milliseconds timeout) {
+        ready.clear();
+
+        {
+            std::lock_guard<std::mutex> guard(lock);
+
+            for (auto event : retired) CloseHandle(event);
+            retired.clear();
+
+            waiting.assign(1, wake);
+            waiting_devices.assign(1, nullptr);
+
+            for (auto &[device, event] : events) {
+                waiting.push_back(event);
+                waiting_devices.push_back(device);
+            }
+        }
+
+        DWORD result = WaitForMultipleObjects((DWORD)waiting.size(), waiting.data(), FALSE, (DWORD)timeout.count());
+        if (result == WAIT_TIMEOUT || result == WAIT_FAILED) return 0;
+
+        // The wait only names the first event signalled, so look at the rest too. Each stays
+        // signalled until its device is read and the next read started.
+        for (size_t i = 1; i < waiting.size(); i++) {
+            if (WaitForSingleObject(waiting[i], 0) == WAIT_OBJECT_0) ready.push_back(waiting_devices[i]);
+        }
+
+        return ready.size();
+    }
+
+#else
+
+    Poller::Poller() : handle(-1) {}
+    Poller::~Poller() {}
+
+    bool Poller::supported() {
+        return false;
+    }
+
+    int Poller::open(const char *path) {
+        return -1;
+    }
+
+    void Poller::close(int fd) {}
+
+    int Poller::read(int fd, unsigned char *buffer, size_t length) {
+        return -1;
+    }
+
+    bool Poller::add(DeviceInfo *device) {
+        return false;
+    }
+
+    void Poller::remove(DeviceInfo *device) {}
+
+    size_t Poller::wait(std::vector<DeviceInfo*> &ready, std::chrono::milliseconds timeout) {
+        ready.clear();
+        return 0;
+    }
+
+#endif
+
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace HID {
+
+    struct DeviceInfo;
+
+    /**
+     * Waits for reports to arrive on a set of devices.
+     *
+     * On Linux this is an epoll set over the devices' hidraw file descriptors.
+     * On Windows each handle keeps an overlapped read in flight, and the poller
+     * waits on their completion events. On platforms where device handles can't
+     * be waited on, `supported()` is false and callers fall back to polling the
+     * devices on a timer.
+     */
+    class Poller {
+        public:
+            Poller();
+            ~Poller();
+
+            Poller(const Poller&) = delete;
+            Poller& operator=(const Poller&) = delete;
+
+            /**
+             * Whether this platform can wait on device handles at all.
+             */
+            static bool supported();
+
+            /**
+             * Open a waitable, non-blocking read handle for the HID interface at `path`.
+             *
+             * Returns -1 if the platform or the hidapi backend doesn't expose one
+             * (e.g. the libusb backend, whose paths aren't device nodes), or if the
+             * OS won't share the device for reading (keyboards and mice on Windows).
+             */
+            static int open(const char *path);
+            static void close(int fd);
+
+            /**
+             * Read a single report from a handle returned by `open`.
+             *
+             * Returns the report length, 0 if no report is pending, or -1 on error.
+             */
+            static int read(int fd, unsigned char *buffer, size_t length);
+
+            bool add(DeviceInfo *device);
+            void remove(DeviceInfo *device);
+
+            /**
+             * Wait up to `timeout` for any device to have a report ready.
+             *
+             * `ready` is cleared and filled with the devices that can be read.
+             * Returns the number of ready devices.
+             */
+            size_t wait(std::vector<DeviceInfo*> &ready, std::chrono::milliseconds timeout);
+
+        private:
+            int handle;
+
+#if _WIN32
+            // Duplicates of the devices' read events, so a device can be closed while a wait holds its event
+            std::mutex lock;
+            std::vector<std::pair<DeviceInfo*, void*>> events;
+
+            // Events of removed devices, closed by the next wait once nothing can be waiting on them
+            std::vector<void*> retired;
+
+            // Signalled when the devices change, so a wait in progress picks them up
+            void *wake = nullptr;
+
+            // The handles of the current wait (waiting thread only)
+            std::vector<void*> waiting;
+            std::vector<DeviceInfo*> waiting_devices;
+#endif
+    };
+
+}
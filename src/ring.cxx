@@ -0,0 +1,158 @@
+#include "ring.hxx"
+
+#include <string.h>
+
+namespace HID {
+
+    /**
+     * Number of arena words needed to store `length` bytes.
+     */
+    static inline size_t words_for(size_t length) {
+        return (length + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    }
+
+    ReportRing::ReportRing(size_t capacity, size_t max_length) :
+        entries(new Entry[capacity]()),
+        entry_count(capacity),
+        length_limit(max_length > BUFFER_SIZE ? BUFFER_SIZE : max_length),
+        written(0),
+        tail(0),
+        write_offset(0) {
+
+        // One spare report's worth covers the space left unused when a report doesn't fit before the end.
+        arena_words = (capacity + 1) * words_for(length_limit > 0 ? length_limit : 1);
+        arena.reset(new std::atomic<uint64_t>[arena_words]());
+    }
+
+    size_t ReportRing::capacity_for(size_t bytes, size_t max_length) {
+        // The arena's spare report comes out of the same bytes
+        size_t report_bytes = words_for(max_length > 0 ? max_length : 1) * sizeof(uint64_t);
+        if (bytes <= report_bytes) return 0;
+
+        return (bytes - report_bytes) / (sizeof(Entry) + report_bytes);
+    }
+
+    size_t ReportRing::capacity() const {
+        return entry_count;
+    }
+
+    size_t ReportRing::max_length() const {
+        return length_limit;
+    }
+
+    size_t ReportRing::memory_usage() const {
+        return entry_count * sizeof(Entry) + arena_words * sizeof(uint64_t);
+    }
+
+    uint64_t ReportRing::head() const {
+        return written.load(std::memory_order_acquire);
+    }
+
+    void ReportRing::push(const unsigned char *data, int length, uint64_t arrival, uint32_t latency, bool queued, bool repeated) {
+        uint64_t sequence = written.load(std::memory_order_relaxed);
+        Entry &entry = entries[sequence % entry_count];
+
+        if (length < 0) length = 0;
+        if ((size_t)length > length_limit) length = (int)length_limit;
+
+        size_t words = words_for(length);
+
+        // The index entry being replaced belongs to a report which is about to fall out of the ring anyway.
+        if (sequence >= entry_count && tail <= sequence - entry_count) tail = sequence - entry_count + 1;
+
+        if (write_offset + words > arena_words) {
+            // Reports between here and the end are older than everything at the start, so they go first.
+            while (tail < sequence && entries[tail % entry_count].offset.load(std::memory_order_relaxed) >= write_offset) {
+                entries[tail % entry_count].sequence.store(2 * tail + 1, std::memory_order_relaxed);
+                tail++;
+            }
+
+            write_offset = 0;
+        }
+
+        // Reclaim the oldest reports which overlap the space this one is about to use.
+        while (tail < sequence) {
+            Entry &old = entries[tail % entry_count];
+            size_t start = old.offset.load(std::memory_order_relaxed),
+                   end = start + words_for(old.length.load(std::memory_order_relaxed));
+
+            if (end <= write_offset || start >= write_offset + words) break;
+
+            old.sequence.store(2 * tail + 1, std::memory_order_relaxed);
+            tail++;
+        }
+
+        // Payload stores are release so that a reader which sees any of them also sees the odd sequence.
+        entry.sequence.store(2 * sequence + 1, std::memory_order_relaxed);
+        entry.offset.store((uint32_t)write_offset, std::memory_order_release);
+        entry.length.store(length, std::memory_order_release);
+        entry.arrival.store(arrival, std::memory_order_release);
+        entry.latency.store(latency, std::memory_order_release);
+        entry.repeated.store(repeated, std::memory_order_release);
+        entry.queued.store(queued, std::memory_order_release);
+
+        for (size_t i = 0; i < words; i++) {
+            uint64_t word = 0;
+            size_t n = length - i * sizeof(uint64_t);
+            memcpy(&word, data + i * sizeof(uint64_t), n < sizeof(word) ? n : sizeof(word));
+            arena[write_offset + i].store(word, std::memory_order_release);
+        }
+
+        write_offset += words;
+
+        entry.sequence.store(2 * sequence + 2, std::memory_order_release);
+        written.store(sequence + 1, std::memory_order_release);
+    }
+
+    void ReportRing::repeat(uint64_t time) {
+        DeviceBuffer previous;
+
+        // Only the producer writes reports, so its own newest report can't be torn.
+        if (!latest(previous)) return;
+
+        push(previous.buffer, previous.length, time, 0, true, true);
+    }
+
+    bool ReportRing::read(uint64_t sequence, DeviceBuffer &out) const {
+        const Entry &entry = entries[sequence % entry_count];
+        uint64_t expected = 2 * sequence + 2;
+
+        if (entry.sequence.load(std::memory_order_acquire) != expected) return false;
+
+        // Acquire loads keep the second sequence check below from moving up past the copy.
+        size_t offset = entry.offset.load(std::memory_order_acquire);
+        int32_t length = entry.length.load(std::memory_order_acquire);
+        uint64_t arrival = entry.arrival.load(std::memory_order_acquire);
+        uint32_t latency = entry.latency.load(std::memory_order_acquire);
+        bool repeated = entry.repeated.load(std::memory_order_acquire);
+        bool queued = entry.queued.load(std::memory_order_acquire);
+
+        if (length < 0 || (size_t)length > length_limit || offset + words_for(length) > arena_words) return false;
+
+        for (size_t i = 0; i * sizeof(uint64_t) < (size_t)length; i++) {
+            uint64_t word = arena[offset + i].load(std::memory_order_acquire);
+            size_t n = length - i * sizeof(uint64_t);
+            memcpy(out.buffer + i * sizeof(uint64_t), &word, n < sizeof(word) ? n : sizeof(word));
+        }
+
+        if (entry.sequence.load(std::memory_order_relaxed) != expected) return false;
+
+        out.length = length;
+        out.arrival = arrival;
+        out.latency = latency;
+        out.repeated = repeated;
+        out.queued = queued;
+
+        return true;
+    }
+
+    bool ReportRing::latest(DeviceBuffer &out) const {
+        // Retry until a consistent copy is taken; the producer only ever moves forward.
+        for (uint64_t h = head(); h > 0; h = head()) {
+            if (read(h - 1, out)) return true;
+        }
+
+        return false;
+    }
+
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include <stdint.h>
+
+namespace HID {
+
+    // Size of each buffer.
+    const size_t BUFFER_SIZE  = 256;
+
+    typedef struct {
+        int length;
+        unsigned char buffer[BUFFER_SIZE];  
+
+        // Monotonic arrival time in ns, see `Clock::now`
+        uint64_t arrival;
+
+        // ns from the report's arrival until it had been read
+        uint32_t latency;
+
+        // Set when nothing new arrived and this is a copy of the previous report
+        bool repeated;
+
+        // Set when the report was found already queued (behind another report, or on a
+        // polling tick), so `arrival` is only when it was read rather than when it arrived
+        bool queued;
+    } DeviceBuffer;
+
+    /**
+     * A single-producer, multi-consumer ring of reports.
+     *
+     * Reports are packed back to back into an arena at their actual length, and
+     * an index with one entry per report gives O(1) access to any of the last
+     * `capacity()` reports. The arena is sized for `capacity()` reports of the
+     * longest length the device can send, so a short report costs only its own
+     * bytes plus its index entry.
+     *
+     * Every index entry carries a sequence number which the producer makes odd
+     * while it writes the report, or while it reclaims the report's bytes, and
+     * even once a report is complete (a seqlock). Consumers copy a report and
+     * then check its sequence again, skipping it if the producer got there in
+     * the meantime. The capture thread never waits for a consumer, and consumers
+     * never see a torn report.
+     */
+    class ReportRing {
+        public:
+            /**
+             * Create a ring holding the last `capacity` reports of up to `max_length` bytes.
+             */
+            ReportRing(size_t capacity, size_t max_length);
+
+            ReportRing(const ReportRing&) = delete;
+            ReportRing& operator=(const ReportRing&) = delete;
+
+            /**
+             * Number of reports of up to `max_length` bytes which fit in `bytes` of memory.
+             */
+            static size_t capacity_for(size_t bytes, size_t max_length);
+
+            size_t capacity() const;
+            size_t max_length() const;
+
+            /**
+             * Bytes allocated for the index and arena.
+             */
+            size_t memory_usage() const;
+
+            /**
+             * Number of reports ever pushed. The newest report is `head() - 1`.
+             */
+            uint64_t head() const;
+
+            /**
+             * Append a report, reclaiming the oldest ones as needed.
+             *
+             * Reports longer than `max_length()` are truncated. `queued` and `repeated`
+             * are the flags of the same names in `DeviceBuffer`.
+             * Must only be called from the capture thread.
+             */
+            void push(const unsigned char *data, int length, uint64_t arrival, uint32_t latency, bool queued, bool repeated = false);
+
+            /**
+             * Append a copy of the newest report, for polled devices which had nothing new.
+             *
+             * The copy is stamped with `time` and flagged as repeated and queued.
+             * Must only be called from the capture thread.
+             */
+            void repeat(uint64_t time);
+
+            /**
+             * Copy report number `sequence` into `out`.
+             *
+             * Returns false if that report hasn't been written yet, has already been
+             * reclaimed, or was being reclaimed while it was copied.
+             */
+            bool read(uint64_t sequence, DeviceBuffer &out) const;
+
+            /**
+             * Copy the newest report into `out`. Returns false if there is none.
+             */
+            bool latest(DeviceBuffer &out) const;
+
+            /**
+             * Call `fn(sequence, report)` for every report in `[from, to)` which could
+             * be read consistently. Returns the number of reports visited.
+             */
+            template<typename F>
+            size_t for_each(uint64_t from, uint64_t to, F &&fn) const {
+                DeviceBuffer report;
+                size_t visited = 0;
+
+                if (from >= to) return 0;
+                if (to - from > entry_count) from = to - entry_count;
+
+                for (uint64_t sequence = from; sequence < to; sequence++) {
+                    if (read(sequence, report)) {
+                        fn(sequence, (const DeviceBuffer&)report);
+                        visited++;
+                    }
+                }
+
+                return visited;
+            }
+
+        private:
+            struct Entry {
+                // 2 * (n + 1) once report n is complete, odd while it is being written or reclaimed
+                std::atomic<uint64_t> sequence;
+
+                // Position of the report in the arena, in words
+                std::atomic<uint32_t> offset;
+                std::atomic<int32_t> length;
+
+                std::atomic<uint64_t> arrival;
+                std::atomic<uint32_t> latency;
+                std::atomic<bool> repeated;
+                std::atomic<bool> queued;
+            };
+
+            std::unique_ptr<Entry[]> entries;
+            size_t entry_count;
+
+            // Report bytes are kept as words so that they can be copied with atomic accesses while being overwritten.
+            std::unique_ptr<std::atomic<uint64_t>[]> arena;
+            size_t arena_words;
+
+            size_t length_limit;
+
+            std::atomic<uint64_t> written;
+
+            // Producer-only state: the oldest report whose bytes are intact, and where the next report goes
+            uint64_t tail;
+            size_t write_offset;
+    };
+
+}
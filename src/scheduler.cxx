@@ -0,0 +1,234 @@
+#include "scheduler.hxx"
+#include "hid.hxx"
+#include "clock.hxx"
+
+#include <algorithm>
+
+namespace HID {
+
+    // How long an idle worker sleeps before re-checking whether it should exit or rebalance
+    const auto IDLE_WAIT = std::chrono::milliseconds(100);
+
+    Scheduler::Scheduler() : running(false), mode(CaptureMode::Event) {}
+
+    Scheduler::~Scheduler() {
+        stop();
+    }
+
+    void Scheduler::start(size_t worker_count, CaptureMode mode) {
+        this->mode = mode;
+        running = true;
+
+        for (size_t i = 0; i < std::max<size_t>(worker_count, 1); i++) {
+            workers.emplace_back(std::make_unique<Worker>());
+        }
+
+        for (size_t i = 0; i < workers.size(); i++) {
+            workers[i]->thread = std::thread(&Scheduler::run, this, i);
+        }
+    }
+
+    void Scheduler::stop() {
+        running = false;
+
+        for (auto &worker : workers) {
+            if (worker->thread.joinable()) worker->thread.join();
+        }
+    }
+
+    size_t Scheduler::worker_count() {
+        return workers.size();
+    }
+
+    uint32_t Scheduler::worker_load(size_t worker) {
+        return worker < workers.size() ? workers[worker]->load.load(std::memory_order_relaxed) : 0;
+    }
+
+    void Scheduler::add(DeviceInfo *device) {
+        std::lock_guard<std::mutex> guard(steal_lock);
+
+        size_t best = 0;
+
+        for (size_t i = 1; i < workers.size(); i++) {
+            auto load = workers[i]->load.load(std::memory_order_relaxed),
+                 best_load = workers[best]->load.load(std::memory_order_relaxed);
+
+            // Idle devices report nothing, so break ties on device count
+            if (load < best_load || (load == best_load && workers[i]->devices.size() < workers[best]->devices.size())) {
+                best = i;
+            }
+        }
+
+        attach(best, device);
+    }
+
+    void Scheduler::remove(DeviceInfo *device) {
+        std::lock_guard<std::mutex> guard(steal_lock);
+
+        int owner = device->worker.load();
+        if (owner >= 0) detach(owner, device);
+    }
+
+    void Scheduler::attach(size_t index, DeviceInfo *device) {
+        Worker *worker = workers[index].get();
+        std::lock_guard<std::mutex> guard(worker->lock);
+
+        device->worker = (int)index;
+        worker->devices.push_back(device);
+
+        if (mode == CaptureMode::Event) worker->poller.add(device);
+    }
+
+    void Scheduler::detach(size_t index, DeviceInfo *device) {
+        Worker *worker = workers[index].get();
+
+        // Taking the lock waits out any drain in progress on this device.
+        std::lock_guard<std::mutex> guard(worker->lock);
+
+        worker->poller.remove(device);
+        std::erase(worker->devices, device);
+        device->worker = -1;
+    }
+
+    void Scheduler::run(size_t index) {
+        Worker *worker = workers[index].get();
+        std::vector<DeviceInfo*> ready;
+
+        auto now = std::chrono::steady_clock::now();
+        auto next_tick = now, last_balance = now;
+
+        while (running) {
+            bool polling;
+
+            {
+                std::lock_guard<std::mutex> guard(worker->lock);
+                polling = std::any_of(worker->devices.begin(), worker->devices.end(), [this](DeviceInfo *d) {
+                    return mode == CaptureMode::Polling || d->fd < 0;
+                });
+            }
+
+            auto timeout = IDLE_WAIT;
+
+            if (polling) {
+                timeout = std::clamp(
+                    std::chrono::ceil<std::chrono::milliseconds>(next_tick - std::chrono::steady_clock::now()),
+                    std::chrono::milliseconds(0),
+                    IDLE_WAIT
+                );
+            }
+
+            if (Poller::supported() && mode == CaptureMode::Event) {
+                worker->poller.wait(ready, timeout);
+            } else {
+                ready.clear();
+                std::this_thread::sleep_for(timeout);
+            }
+
+            now = std::chrono::steady_clock::now();
+            uint64_t wake = Clock::now();
+
+            {
+                std::lock_guard<std::mutex> guard(worker->lock);
+
+                for (auto device : ready) {
+                    // The device may have been stolen, or removed and freed, since the wait returned,
+                    // so it's only dereferenced once it's known to still be one of ours.
+                    if (std::find(worker->devices.begin(), worker->devices.end(), device) == worker->devices.end()) continue;
+
+                    drain_reports(device, false, wake);
+
+                    // An unplugged device stays readable forever; stop waiting on it until it's removed.
+                    if (device->disconnected.load(std::memory_order_relaxed)) worker->poller.remove(device);
+                }
+
+                if (polling && now >= next_tick) {
+                    for (auto device : worker->devices) {
+                        if (device->disconnected.load(std::memory_order_relaxed)) continue;
+                        if (mode == CaptureMode::Polling || device->fd < 0) drain_reports(device, true, wake);
+                    }
+
+                    next_tick += std::chrono::microseconds( SAMPLE_INTERVAL );
+                    if (next_tick < now) next_tick = now + std::chrono::microseconds( SAMPLE_INTERVAL );
+                }
+            }
+
+            if (now - last_balance >= BALANCE_INTERVAL) {
+                balance(index, now - last_balance);
+                last_balance = now;
+            }
+        }
+    }
+
+    void Scheduler::balance(size_t index, std::chrono::steady_clock::duration elapsed) {
+        Worker *self = workers[index].get();
+        double seconds = std::chrono::duration<double>(elapsed).count();
+
+        {
+            std::lock_guard<std::mutex> guard(self->lock);
+            uint32_t load = 0;
+
+            for (auto device : self->devices) {
+                uint64_t read = device->counters.reports_read.load(std::memory_order_relaxed);
+                uint32_t rate = (uint32_t)((read - device->rate_mark) / seconds);
+
+                device->rate_mark = read;
+                device->rate.store(rate, std::memory_order_relaxed);
+                load += rate;
+            }
+
+            self->load.store(load, std::memory_order_relaxed);
+        }
+
+        std::lock_guard<std::mutex> guard(steal_lock);
+
+        size_t busiest = index;
+
+        for (size_t i = 0; i < workers.size(); i++) {
+            if (workers[i]->load.load(std::memory_order_relaxed) > workers[busiest]->load.load(std::memory_order_relaxed)) {
+                busiest = i;
+            }
+        }
+
+        if (busiest == index) return;
+
+        Worker *victim = workers[busiest].get();
+        uint32_t victim_load = victim->load.load(std::memory_order_relaxed),
+                 self_load = self->load.load(std::memory_order_relaxed);
+
+        if (victim_load - self_load < BALANCE_THRESHOLD) return;
+
+        DeviceInfo *best = nullptr;
+        uint32_t gap = victim_load - self_load;
+
+        {
+            std::lock_guard<std::mutex> guard(victim->lock);
+
+            // A worker with one device has nothing to give away.
+            if (victim->devices.size() < 2) return;
+
+            for (auto device : victim->devices) {
+                uint32_t rate = device->rate.load(std::memory_order_relaxed);
+
+                // Moving `rate` changes the gap to |gap - 2 * rate|; only take devices that shrink it.
+                if (rate == 0 || rate >= gap) continue;
+
+                uint32_t remaining = (uint32_t)std::abs((int64_t)gap - 2 * (int64_t)rate);
+
+                if (best == nullptr || remaining < (uint32_t)std::abs((int64_t)gap - 2 * (int64_t)best->rate.load(std::memory_order_relaxed))) {
+                    best = device;
+                }
+            }
+        }
+
+        if (best == nullptr) return;
+
+        uint32_t rate = best->rate.load(std::memory_order_relaxed);
+
+        detach(busiest, best);
+        attach(index, best);
+
+        victim->load.fetch_sub(rate, std::memory_order_relaxed);
+        self->load.fetch_add(rate, std::memory_order_relaxed);
+    }
+
+}
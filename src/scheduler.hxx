@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <stdint.h>
+
+#include "poller.hxx"
+
+namespace HID {
+
+    struct DeviceInfo;
+    enum class CaptureMode : uint8_t;
+
+    // Upper bound on the default number of capture workers
+    const size_t DEFAULT_MAX_READERS = 4;
+
+    // How often each worker measures its devices and considers stealing one
+    const auto BALANCE_INTERVAL = std::chrono::milliseconds(500);
+
+    // Minimum load difference, in reports per second, worth moving a device for
+    const uint32_t BALANCE_THRESHOLD = 250;
+
+    /**
+     * A pool of capture workers which share the devices between them.
+     *
+     * Each worker owns a set of devices and waits on them with its own `Poller`.
+     * New devices go to the least loaded worker. Every `BALANCE_INTERVAL` each
+     * worker measures the report rate of its devices, and a worker which is
+     * well below the busiest one steals the device which best evens out their
+     * load. This keeps a handful of fast devices from sharing one thread while
+     * idle keyboards and mice cost nothing.
+     */
+    class Scheduler {
+        public:
+            Scheduler();
+            ~Scheduler();
+
+            /**
+             * Start `worker_count` capture workers.
+             */
+            void start(size_t worker_count, CaptureMode mode);
+
+            /**
+             * Stop and join every worker. Devices stay assigned but are no longer read.
+             */
+            void stop();
+
+            /**
+             * Hand a device to the least loaded worker.
+             */
+            void add(DeviceInfo *device);
+
+            /**
+             * Take a device away from its worker.
+             *
+             * When this returns the device is not being read and won't be again, so it
+             * can be freed. A worker which was woken for it checks that it still owns
+             * the device before touching it.
+             */
+            void remove(DeviceInfo *device);
+
+            size_t worker_count();
+
+            /**
+             * Reports per second currently handled by the given worker.
+             */
+            uint32_t worker_load(size_t worker);
+
+        private:
+            struct Worker {
+                // Held while the worker reads its devices, and by anyone moving a device off it.
+                // `devices` is only changed with both this and `steal_lock` held.
+                std::mutex lock;
+                Poller poller;
+                std::vector<DeviceInfo*> devices;
+                std::atomic<uint32_t> load;
+                std::thread thread;
+            };
+
+            std::vector<std::unique_ptr<Worker>> workers;
+            std::atomic<bool> running;
+            CaptureMode mode;
+
+            /**
+             * Held while moving a device, so two thieves can't pick the same one.
+             */
+            std::mutex steal_lock;
+
+            /**
+             * Capture loop for a single worker.
+             *
+             * Sleeps until one of its devices has a report ready, or until the next
+             * `SAMPLE_INTERVAL` tick if it owns devices which have to be polled.
+             * Every report queued by the OS is drained on each wake.
+             */
+            void run(size_t index);
+
+            /**
+             * Measure the worker's devices and steal one from the busiest worker if
+             * that would narrow the gap between them.
+             */
+            void balance(size_t index, std::chrono::steady_clock::duration elapsed);
+
+            void attach(size_t index, DeviceInfo *device);
+            void detach(size_t index, DeviceInfo *device);
+    };
+
+}
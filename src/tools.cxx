@@ -1,4 +1,9 @@
 #include <stdio.h>
+#include <string>
+#include <type_traits>
+
+#include <fmt/format.h>
+
 #include "hid.hxx"
 #include "hid_descriptor.hxx"
 
@@ -12,6 +17,9 @@ void save_devices(const char *path) {
         uint8_t sz = 0;
         const hid_device_info *device = HID::GlobalDeviceManager.get_devices();
 
+        // Every descriptor is needed below, so open them all together rather than one at a time
+        HID::GlobalDeviceManager.describe_all();
+
         for (; device; device = device->next)
             sz++;
         fwrite(&sz, sizeof(sz), 1, file);
@@ -38,8 +46,8 @@ void save_devices(const char *path) {
             if (sz)
                 fwrite(device->serial_number, sizeof(wchar_t), sz, file);
 
-            auto dev = HID::GlobalDeviceManager.get_device(device);
-            auto descr = HID::Descriptor::parse(dev->report_descriptor.data, dev->report_descriptor.length);
+            auto dev = HID::GlobalDeviceManager.describe(device);
+            const auto &descr = *dev->descriptor;
 
             sz = descr.inputs.size();
             fwrite(&sz, sizeof(sz), 1, file);
@@ -67,4 +75,60 @@ void save_devices(const char *path) {
 
         fclose(file);
     }
+}
+
+/**
+ * Quote a string for JSON, escaping anything outside printable ASCII.
+ */
+template<typename C>
+static std::string json_string(const C *value) {
+    std::string out = "\"";
+
+    for (; value && *value; value++) {
+        uint32_t c = (std::make_unsigned_t<C>)*value;
+
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += (char)c;
+        } else if (c >= 0x20 && c < 0x7F) {
+            out += (char)c;
+        } else {
+            out += fmt::format("\\u{:04x}", c & 0xFFFF);
+        }
+    }
+
+    return out + "\"";
+}
+
+void save_timing(const char *path) {
+    FILE *file = fopen(path, "w");
+
+    if (!file) return;
+
+    fmt::print(file, "[\n");
+
+    bool first = true;
+
+    for (auto device = HID::GlobalDeviceManager.get_devices(); device; device = device->next) {
+        auto stats = HID::GlobalDeviceManager.get_interval_stats(device);
+        auto counters = HID::GlobalDeviceManager.get_counters(device);
+
+        fmt::print(file, "{}  {{\"vendor_id\": {}, \"product_id\": {}, \"interface\": {}, \"product\": {}, \"path\": {},\n",
+            first ? "" : ",\n",
+            device->vendor_id, device->product_id, device->interface_number,
+            json_string(device->product_string), json_string(device->path));
+
+        fmt::print(file, "   \"reports_read\": {}, \"queue_possibly_full\": {}, \"ring_overwrites\": {},\n",
+            counters.reports_read, counters.queue_possibly_full, counters.ring_overwrites);
+
+        fmt::print(file, "   \"intervals_ns\": {{\"count\": {}, \"min\": {}, \"mean\": {:.1f}, \"p50\": {}, \"p99\": {}, \"p99_9\": {}, \"max\": {}}},\n",
+            stats.count, stats.count ? stats.min : 0, stats.mean, stats.p50, stats.p99, stats.p999, stats.max);
+
+        fmt::print(file, "   \"polling_rate_hz\": {:.1f}}}", stats.polling_rate);
+
+        first = false;
+    }
+
+    fmt::print(file, "\n]\n");
+    fclose(file);
 }
\ No newline at end of file
@@ -1,3 +1,8 @@
 #pragma once
 
-void save_devices(const char*);
\ No newline at end of file
+void save_devices(const char*);
+
+/**
+ * Write the report timing statistics of every device to `path` as JSON.
+ */
+void save_timing(const char*);
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include <vector>
 #include <locale>
 #include <codecvt>
+#include <inttypes.h>
 
 #include <fmt/format.h>
 #include <fmt/chrono.h>
@@ -8,6 +9,7 @@
 #include "ui.hxx"
 #include "../hid.hxx"
 #include "../hid_descriptor.hxx"
+#include "../usage_set.hxx"
 #include "../widgets/pov_hat.hxx"
 #include "../tools.hxx"
 #include "imgui/imgui.h"
@@ -47,12 +49,20 @@ struct {
         bool shown = false ;
     } device_debugger;
 
-    std::map<char*, bool> shown_devices;
+    struct {
+        bool shown = false;
+        char save_path[256] = "timing.json";
+    } report_timing;
+
+    std::map<std::string, bool, std::less<>> shown_devices;
 
     struct {
         NameList inputs;
         NameList outputs; 
     } custom_labels;
+
+    // Each device's input field units, by path, along with the descriptor they were written out for
+    std::map<std::string, std::pair<std::shared_ptr<const HID::Descriptor::Descriptor>, std::vector<std::string>>, std::less<>> input_units;
 } state;
 
 std::string w2s(const std::wstring& in);
@@ -60,9 +70,55 @@ std::string w2s(const std::wstring& in);
 // Window rendering functions
 inline void RenderDeviceList();
 inline void RenderDeviceDebugger();
+inline void RenderReportTiming();
 inline void RenderDevice(const hid_device_info *device, bool *open);
 
+inline const char* DeviceStateName(HID::DeviceState state) {
+    switch (state) {
+        case HID::DeviceState::Enumerated: return "Enumerated";
+        case HID::DeviceState::Opening: return "Opening";
+        case HID::DeviceState::Described: return "Described";
+        case HID::DeviceState::Capturing: return "Capturing";
+        case HID::DeviceState::Failed: return "Failed";
+        case HID::DeviceState::TimedOut: return "Timed Out";
+    }
+
+    return "Unknown";
+}
+
+inline const char* CollectionTypeName(HID::Descriptor::CollectionType type) {
+    using HID::Descriptor::CollectionType;
+
+    switch (type) {
+        case CollectionType::Physical: return "Physical";
+        case CollectionType::Application: return "Application";
+        case CollectionType::Logical: return "Logical";
+        case CollectionType::Report: return "Report";
+        case CollectionType::NamedArray: return "Named Array";
+        case CollectionType::UsageSwitch: return "Usage Switch";
+        case CollectionType::UsageModifier: return "Usage Modifier";
+    }
+
+    return "Vendor-Defined";
+}
+
 void UI::Setup() {
+    // Devices listed in the profile (one `vvvv:pppp` hex pair per line) are captured from the start
+    FILE *profile = fopen("profile.txt", "r");
+
+    if (profile) {
+        unsigned int vendor_id, product_id;
+
+        while (fscanf(profile, "%x:%x", &vendor_id, &product_id) == 2) {
+            HID::GlobalDeviceManager.add_profile_device(vendor_id, product_id);
+        }
+
+        fclose(profile);
+    }
+
+    // Parsed descriptors are kept between runs, so devices seen before come up without being parsed again
+    HID::GlobalDeviceManager.set_descriptor_cache("descriptors.cache");
+
     for (auto device = HID::GlobalDeviceManager.get_devices(); device; device = device->next) {
         state.shown_devices.emplace(device->path, false);
     }
@@ -96,8 +152,12 @@ void UI::Setup() {
 }
 
 void UI::Render() {
+    // Pick up devices which were plugged in or removed before walking the device list
+    HID::GlobalDeviceManager.update();
+
     RenderDeviceList();
     if (state.device_debugger.shown) RenderDeviceDebugger();
+    if (state.report_timing.shown) RenderReportTiming();
 
     if (state.main_menu.imgui_demo) ImGui::ShowDemoWindow(&state.main_menu.imgui_demo);
     if (state.main_menu.imgui_debug) ImGui::ShowMetricsWindow(&state.main_menu.imgui_debug);
@@ -113,6 +173,7 @@ inline void RenderDeviceList() {
             if (ImGui::BeginMenu("Devices")) {
                 ImGui::MenuItem("Device List", "", &state.device_list.shown);
                 ImGui::MenuItem("Device Debugger", "", &state.device_debugger.shown);
+                ImGui::MenuItem("Report Timing", "", &state.report_timing.shown);
                 ImGui::EndMenu();
             }
 
@@ -140,7 +201,8 @@ inline void RenderDeviceList() {
             char label[512];
             sprintf_s(label, "%ls #%d  ##%s", device->product_string, device->interface_number, device->path);
 
-            auto shown = state.shown_devices.find(device->path);
+            // Devices plugged in after startup won't have an entry yet
+            auto shown = state.shown_devices.try_emplace(device->path, false).first;
             ImGui::Selectable(label, &shown->second);
             if (shown->second) RenderDevice(device, &shown->second);
         }
@@ -151,10 +213,10 @@ inline void RenderDeviceList() {
 void RenderDatumDebug(const hid_device_info *device, const HID::Descriptor::Node node, const char *node_type) {
     ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen | ImGuiTreeNodeFlags_Bullet;
     uint64_t node_id = INPUT_ID(device->vendor_id, device->product_id, node.report_id, node.report_index);
-    auto def = HID::Descriptor::find_usage_definition(node.usage_page, node.usage_id);
+    const auto &def = HID::Descriptor::find_usage_definition(node.usage_page, node.usage_id);
     auto it = state.custom_labels.inputs.find(node_id);
 
-    char *label = def.name;
+    const char *label = def.name();
 
     if (it != state.custom_labels.inputs.end())
     {
@@ -170,7 +232,7 @@ void RenderDatumDebug(const hid_device_info *device, const HID::Descriptor::Node
     bool open = ImGui::TreeNode((void *)node_id, node_type);
 
     ImGui::TableSetColumnIndex(1);
-    ImGui::Text("Report: %d Offset: %d Usage Page: %02x Usage ID: %04x \"%s\"", node.report_id, node.report_index, node.usage_page, node.usage_id, def.name);
+    ImGui::Text("Report: %d Offset: %d Usage Page: %02x Usage ID: %04x \"%s\"", node.report_id, node.report_index, node.usage_page, node.usage_id, def.name());
 
     if (open)
     {
@@ -203,7 +265,7 @@ void RenderDatumDebug(const hid_device_info *device, const HID::Descriptor::Node
         ImGui::TreeNodeEx("usage_page", flags, "Usage Page");
         ImGui::TableSetColumnIndex(1);
         ImGui::SetNextItemWidth(-FLT_MIN);
-        ImGui::Text("0x%04x", node.usage_page);
+        ImGui::Text("%s (0x%04x)", HID::Descriptor::usage_page_name(node.usage_page), node.usage_page);
 
         ImGui::TableNextRow();
         ImGui::TableSetColumnIndex(0);
@@ -211,7 +273,7 @@ void RenderDatumDebug(const hid_device_info *device, const HID::Descriptor::Node
         ImGui::TreeNodeEx("usage_id", flags, "Usage ID");
         ImGui::TableSetColumnIndex(1);
         ImGui::SetNextItemWidth(-FLT_MIN);
-        ImGui::Text("%s (0x%04x)", def.name, node.usage_id);
+        ImGui::Text("%s (0x%04x)", def.name(), node.usage_id);
 
         ImGui::TableNextRow();
         ImGui::TableSetColumnIndex(0);
@@ -229,9 +291,9 @@ void RenderDatumDebug(const hid_device_info *device, const HID::Descriptor::Node
             ImGui::TableSetColumnIndex(1);
             ImGui::SetNextItemWidth(-FLT_MIN);
 
-            auto dev = HID::GlobalDeviceManager.get_device(device);
-            wchar_t buffer[256];
-            hid_get_indexed_string(dev->device, node.string_index, buffer, 256);
+            wchar_t buffer[256] = {};
+            hid_device *handle = HID::GlobalDeviceManager.open_device(device);
+            if (handle) hid_get_indexed_string(handle, node.string_index, buffer, 256);
 
             ImGui::Text("%ls", buffer);
         }
@@ -252,6 +314,22 @@ void RenderDatumDebug(const hid_device_info *device, const HID::Descriptor::Node
         ImGui::SetNextItemWidth(-FLT_MIN);
         ImGui::Text("%d (0x%04x)", node.max_value, node.max_value);
 
+        ImGui::TableNextRow();
+        ImGui::TableSetColumnIndex(0);
+        ImGui::AlignTextToFramePadding();
+        ImGui::TreeNodeEx("physical_range", flags, "Physical Range");
+        ImGui::TableSetColumnIndex(1);
+        ImGui::SetNextItemWidth(-FLT_MIN);
+        ImGui::Text("%s to %s", HID::Descriptor::physical_min(&node).c_str(), HID::Descriptor::physical_max(&node).c_str());
+
+        ImGui::TableNextRow();
+        ImGui::TableSetColumnIndex(0);
+        ImGui::AlignTextToFramePadding();
+        ImGui::TreeNodeEx("unit", flags, "Unit");
+        ImGui::TableSetColumnIndex(1);
+        ImGui::SetNextItemWidth(-FLT_MIN);
+        ImGui::Text("%s (0x%08x, exponent %d)", HID::Unit(node.unit, node.unit_exp).to_string().c_str(), node.unit, node.unit_exp);
+
         ImGui::TableNextRow();
         ImGui::TableSetColumnIndex(0);
         ImGui::AlignTextToFramePadding();
@@ -283,6 +361,36 @@ void RenderDatumDebug(const hid_device_info *device, const HID::Descriptor::Node
     }
 }
 
+void RenderCollectionDebug(const HID::Descriptor::Descriptor &descriptor, uint32_t index) {
+    using HID::Descriptor::MainItemTag;
+
+    const auto &collection = descriptor.collection(index);
+    const auto &def = HID::Descriptor::find_usage_definition(collection.usage_page, collection.usage);
+
+    auto [first_input, end_input] = descriptor.collection_fields(index, MainItemTag::INPUT);
+    auto [first_output, end_output] = descriptor.collection_fields(index, MainItemTag::OUTPUT);
+    auto [first_feature, end_feature] = descriptor.collection_fields(index, MainItemTag::FEATURE);
+
+    ImGui::TableNextRow();
+    ImGui::TableSetColumnIndex(0);
+    ImGui::AlignTextToFramePadding();
+    bool open = ImGui::TreeNode((void *)(uintptr_t)(index + 1), "%s", CollectionTypeName(collection.type));
+
+    ImGui::TableSetColumnIndex(1);
+    ImGui::Text("\"%s\" (%u inputs, %u outputs, %u features)", def.name(),
+        end_input - first_input, end_output - first_output, end_feature - first_feature);
+
+    if (open) {
+        auto [edge, end] = boost::out_edges(index, descriptor.collections);
+
+        for (; edge != end; edge++) {
+            RenderCollectionDebug(descriptor, (uint32_t)boost::target(*edge, descriptor.collections));
+        }
+
+        ImGui::TreePop();
+    }
+}
+
 void RenderDeviceDebugger(const hid_device_info *device) {
     ImGui::PushID(device);
     
@@ -335,6 +443,40 @@ void RenderDeviceDebugger(const hid_device_info *device) {
         ImGui::SetNextItemWidth(-FLT_MIN);
         ImGui::Text("0x%04x", device->product_id);
 
+        ImGui::TableNextRow();
+        ImGui::TableSetColumnIndex(0);
+        ImGui::AlignTextToFramePadding();
+        ImGui::TreeNodeEx("state", flags, "State");
+        ImGui::TableSetColumnIndex(1);
+        ImGui::SetNextItemWidth(-FLT_MIN);
+        ImGui::Text("%s", DeviceStateName(dev->state));
+
+        ImGui::TableNextRow();
+        ImGui::TableSetColumnIndex(0);
+        ImGui::AlignTextToFramePadding();
+        ImGui::TreeNodeEx("open_time", flags, "Open Time");
+        ImGui::TableSetColumnIndex(1);
+        ImGui::SetNextItemWidth(-FLT_MIN);
+        ImGui::Text("%.3f ms (descriptor %.3f ms)", dev->open_ns / 1e6, dev->describe_ns / 1e6);
+
+        ImGui::TableNextRow();
+        ImGui::TableSetColumnIndex(0);
+        ImGui::AlignTextToFramePadding();
+        ImGui::TreeNodeEx("parse_time", flags, "Parse Time");
+        ImGui::TableSetColumnIndex(1);
+        ImGui::SetNextItemWidth(-FLT_MIN);
+        ImGui::Text("%.3f ms (%s)", dev->parse_ns / 1e6, dev->cached ? "cached" : "parsed");
+
+        ImGui::TableNextRow();
+        ImGui::TableSetColumnIndex(0);
+        ImGui::AlignTextToFramePadding();
+        ImGui::TreeNodeEx("application", flags, "Application");
+        ImGui::TableSetColumnIndex(1);
+        ImGui::SetNextItemWidth(-FLT_MIN);
+        ImGui::Text("%s%s",
+            HID::Descriptor::find_usage_definition(dev->application_usage >> 16, dev->application_usage & 0xFFFF).name(),
+            dev->force_feedback ? " (force feedback)" : "");
+
         ImGui::TableNextRow();
         ImGui::TableSetColumnIndex(0);
         ImGui::AlignTextToFramePadding();
@@ -344,7 +486,10 @@ void RenderDeviceDebugger(const hid_device_info *device) {
             ImGui::TableSetColumnIndex(0);
             ImGui::AlignTextToFramePadding();
 
-            auto descriptor = HID::Descriptor::parse(dev->report_descriptor.data, dev->report_descriptor.length);
+            // Only fetch the descriptor once someone actually looks at it, and without holding up the frame
+            dev = HID::GlobalDeviceManager.request_describe(device);
+
+            const auto &descriptor = *dev->descriptor;
 
             if (ImGui::TreeNode("Inputs")) {
 
@@ -385,6 +530,21 @@ void RenderDeviceDebugger(const hid_device_info *device) {
             ImGui::TableSetColumnIndex(0);
             ImGui::AlignTextToFramePadding();
 
+            if (ImGui::TreeNode("Collections")) {
+
+                for (uint32_t i = 0; i < boost::num_vertices(descriptor.collections); i++) {
+                    if (descriptor.collection(i).parent == HID::Descriptor::NO_COLLECTION) {
+                        RenderCollectionDebug(descriptor, i);
+                    }
+                }
+
+                ImGui::TreePop();
+            }
+
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0);
+            ImGui::AlignTextToFramePadding();
+
             if (ImGui::TreeNode("Save Report")) {
                 ImGui::TableNextRow();
                 ImGui::TableSetColumnIndex(0);
@@ -480,6 +640,94 @@ static void RenderDeviceDebugger() {
 }
 
 
+inline void RenderReportTiming() {
+    ImGui::SetNextWindowSize(ImVec2(900, 400), ImGuiCond_FirstUseEver);
+
+    if (ImGui::Begin("Report Timing##report_timing", &state.report_timing.shown)) {
+        ImVec2 wsz = ImGui::GetWindowSize();
+
+        ImGui::SetNextItemWidth(wsz.x - 256);
+        ImGui::InputText("Path##timing_path", state.report_timing.save_path, 256);
+        ImGui::SameLine();
+
+        if (ImGui::Button("Save Timing", ImVec2(128, 24))) save_timing(state.report_timing.save_path);
+
+        ImGuiTableFlags flags = ImGuiTableFlags_BordersOuter
+            | ImGuiTableFlags_Resizable
+            | ImGuiTableFlags_RowBg
+            | ImGuiTableFlags_ScrollY;
+
+        if (ImGui::BeginTable("##report_timing_table", 9, flags)) {
+            ImGui::TableSetupScrollFreeze(0, 1);
+            ImGui::TableSetupColumn("Device");
+            ImGui::TableSetupColumn("Intervals");
+            ImGui::TableSetupColumn("Rate (Hz)");
+            ImGui::TableSetupColumn("p50 (ms)");
+            ImGui::TableSetupColumn("p99 (ms)");
+            ImGui::TableSetupColumn("p99.9 (ms)");
+            ImGui::TableSetupColumn("Max (ms)");
+            ImGui::TableSetupColumn("Queue Possibly Full");
+            ImGui::TableSetupColumn("");
+            ImGui::TableHeadersRow();
+
+            for (auto device = HID::GlobalDeviceManager.get_devices(); device; device = device->next) {
+                auto stats = HID::GlobalDeviceManager.get_interval_stats(device);
+                auto counters = HID::GlobalDeviceManager.get_counters(device);
+
+                // Devices which haven't sent anything would only be noise, and polled devices have no intervals
+                if (stats.count == 0) continue;
+
+                ImGui::PushID(device);
+                ImGui::TableNextRow();
+
+                ImGui::TableSetColumnIndex(0);
+                ImGui::Text("%ls #%d", device->product_string, device->interface_number);
+                ImGui::TableSetColumnIndex(1);
+                ImGui::Text("%" PRIu64, stats.count);
+                ImGui::TableSetColumnIndex(2);
+                ImGui::Text("%.0f", stats.polling_rate);
+                ImGui::TableSetColumnIndex(3);
+                ImGui::Text("%.3f", stats.p50 / 1e6);
+                ImGui::TableSetColumnIndex(4);
+                ImGui::Text("%.3f", stats.p99 / 1e6);
+                ImGui::TableSetColumnIndex(5);
+                ImGui::Text("%.3f", stats.p999 / 1e6);
+                ImGui::TableSetColumnIndex(6);
+                ImGui::Text("%.3f", stats.max / 1e6);
+                ImGui::TableSetColumnIndex(7);
+                ImGui::Text("%" PRIu64, counters.queue_possibly_full);
+                ImGui::TableSetColumnIndex(8);
+                if (ImGui::SmallButton("Reset")) HID::GlobalDeviceManager.reset_interval_stats(device);
+
+                ImGui::PopID();
+            }
+
+            ImGui::EndTable();
+        }
+    }
+    ImGui::End();
+}
+
+/**
+ * The unit of each of a device's input fields, written out once for each descriptor it has.
+ *
+ * Physical values already have the unit exponent applied, so it's left out.
+ */
+static const std::vector<std::string>& InputUnits(const HID::DeviceInfo *dev) {
+    auto &entry = state.input_units[dev->path];
+
+    if (entry.first != dev->descriptor) {
+        entry.first = dev->descriptor;
+        entry.second.clear();
+
+        for (auto &node : dev->descriptor->inputs) {
+            entry.second.push_back(HID::Unit(node.unit, node.unit_exp).to_string(false));
+        }
+    }
+
+    return entry.second;
+}
+
 inline void RenderDevice(const hid_device_info *device, bool *open) {
     static char title[256];
     const ImGuiWindowFlags flags = ImGuiWindowFlags_NoSavedSettings;
@@ -489,18 +737,57 @@ inline void RenderDevice(const hid_device_info *device, bool *open) {
     device_id <<= 32;
 
     if (ImGui::Begin(title, open, flags)) {
-        const HID::DeviceInfo *dev = HID::GlobalDeviceManager.get_device(device);
-        const HID::DeviceBuffer *data = &(dev->buffers[dev->current_buffer]);
+        // Opening the window is what starts capturing the device
+        const HID::DeviceInfo *dev = HID::GlobalDeviceManager.request_capture(device);
+
+        if (dev->state == HID::DeviceState::Failed || dev->state == HID::DeviceState::TimedOut) {
+            ImGui::Text("Unable to open device (%s): %s", DeviceStateName(dev->state), dev->path.c_str());
+            ImGui::End();
+            return;
+        }
 
-        ImGui::TextUnformatted( fmt::format("Report Date: {}", data->lru).c_str() );
+        if (dev->state != HID::DeviceState::Capturing) {
+            ImGui::Text("Opening device: %s", dev->path.c_str());
+            ImGui::End();
+            return;
+        }
+
+        const HID::DeviceBuffer report = HID::GlobalDeviceManager.get_latest_report(device);
+        const HID::DeviceBuffer *data = &report;
+
+        ImGui::Text("Report Arrival: %.6f s%s", data->arrival / 1e9, data->repeated ? " (repeated)" : "");
+        ImGui::Text("Report Latency: %.1f us", data->latency / 1e3);
         ImGui::Text("Report Length: %d", data->length);
+
+        auto rate = HID::GlobalDeviceManager.get_update_rate(device);
+        ImGui::Text("Update Rate: %.1f Hz  Interval: %.3f ms (min %.3f, max %.3f, stddev %.3f)  Mean Latency: %.1f us",
+            rate.rate, rate.mean_interval / 1e6, rate.min_interval / 1e6, rate.max_interval / 1e6,
+            rate.stddev_interval / 1e6, rate.mean_latency / 1e3);
         
         ImGui::Text("Device Location: 0x%08x", dev);
-        ImGui::Text("Current Report Index: %3d", dev->current_buffer);
-        ImGui::Text("Current Report Location: 0x%08x", data);
+        ImGui::Text("Current Report ID: %u", dev->last_report_id.load());
+
+        size_t history_bytes = 0;
+
+        for (size_t report_id = 0; report_id < HID::MAX_REPORT_IDS; report_id++) {
+            auto ring = dev->reports[report_id].ring.get();
+            if (!ring) continue;
+
+            ImGui::Text("Report %zu History: %" PRIu64 " read, holding %zu of %zu bytes (%zu KiB)",
+                report_id, ring->head(), ring->capacity(), ring->max_length(), ring->memory_usage() / 1024);
+
+            history_bytes += ring->memory_usage();
+        }
+
+        ImGui::Text("History Memory: %zu KiB (budget %zu KiB)", history_bytes / 1024, HID::RING_BYTES / 1024);
+
+        auto counters = HID::GlobalDeviceManager.get_counters(device);
+        ImGui::Text("Reports Read: %" PRIu64 "  Queue Possibly Full: %" PRIu64 "  Ring Overwrites: %" PRIu64,
+            counters.reports_read, counters.queue_possibly_full, counters.ring_overwrites);
+        ImGui::Text("Capture Worker: %d  Report Rate: %u/s", dev->worker.load(), dev->rate.load());
         ImGui::Spacing();
         
-        auto desc = HID::Descriptor::parse(dev->report_descriptor.data, dev->report_descriptor.length);
+        const auto &desc = *dev->descriptor;
 
         if (data->length >= 0) {
             if (ImGui::CollapsingHeader("Raw Data")) { 
@@ -512,43 +799,51 @@ inline void RenderDevice(const hid_device_info *device, bool *open) {
                 auto w = ImGui::GetWindowSize().x - 192;
                 w = w > 256 ? w : 256;
 
-                for (auto input : desc.inputs) {
-                    uint64_t input_id = device_id | (input.report_id << 16) | (uint16_t)input.report_index;
+                const auto &fields = desc.input_fields;
+                const auto &units = InputUnits(dev);
 
-                    float *series = HID::GlobalDeviceManager.get_input_series(device, &input);
+                for (uint32_t row = 0; row < fields.size(); row++) {
+                    uint8_t report_size = fields.sizes[row];
+                    uint64_t input_id = device_id | (fields.report_ids[row] << 16) | (uint16_t)fields.offsets[row];
 
-                    auto def = HID::Descriptor::find_usage_definition(input.usage_page, input.usage_id);
+                    float *series = HID::GlobalDeviceManager.get_input_series(device, fields.handle(row));
+
+                    const auto &def = HID::Descriptor::find_usage_definition(fields.usage_pages[row], fields.usages[row]);
                     auto label_it = state.custom_labels.inputs.find(input_id);
 
-                    char *label;
+                    const char *label;
 
                     if (label_it == state.custom_labels.inputs.end()) {
-                        label = def.name; 
+                        label = def.name(); 
                     } else {
                         label = label_it->second.second;
                     }
 
 
-                    if (input.report_size == 1) {
+                    if (report_size == 1) {
                         ImGui::PlotHistogram(
                             label, // Label
                             series,                                                       // Series Data,
                             HID::NUM_BUFFERS,                                             // Series Length
-                            dev->current_buffer,                                          // Series Offset,
+                            0,                                                            // Series Offset,
                             "",
                             0,                                                            // Minimum Value
                             1,
                             ImVec2(w, 16.0f)                                              // Graph Size
                         );
                     } else {
+                        // The newest value, and what it means in physical units
+                        float latest = series[HID::NUM_BUFFERS - 1];
+                        auto overlay = fmt::format("{:05.0f} = {:.4g} {}", latest, fields.physical(row, (int32_t)latest), units[row]);
+
                         ImGui::PlotLines(
                             label,                                                        // Label
                             series,                                                       // Series Data,
                             HID::NUM_BUFFERS,                                             // Series Length
-                            dev->current_buffer,                                          // Series Offset,
-                            fmt::format("{:05.0f}", series[dev->current_buffer]).c_str(), // Overlay text
+                            0,                                                            // Series Offset,
+                            overlay.c_str(),                                              // Overlay text
                             0,                                                            // input.min_value,                                              // Minimum Value
-                            1 << input.report_size,                                       // input.max_value,                                              // Maximum Value
+                            1 << report_size,                                             // input.max_value,                                              // Maximum Value
                             ImVec2(w, 48.0f)                                              // Graph Size
                         );
                     }
@@ -557,12 +852,35 @@ inline void RenderDevice(const hid_device_info *device, bool *open) {
                 }
             }
 
+            if (!desc.arrays.empty() && ImGui::CollapsingHeader("Arrays")) {
+                HID::UsageSet pressed;
+
+                for (auto &array : desc.arrays) {
+                    if (array.type != HID::Descriptor::MainItemTag::INPUT) continue;
+
+                    auto latest = HID::GlobalDeviceManager.get_latest_report(device, dev->numbered ? array.report_id : 0);
+                    if (latest.length <= 0) continue;
+
+                    HID::decode_array(desc, array, latest.buffer, latest.length, pressed);
+
+                    std::string names;
+                    pressed.for_each([&](uint32_t index) {
+                        const auto &def = HID::Descriptor::find_usage_definition(array.usage_page, desc.array_usage(array, index));
+                        if (!names.empty()) names += ", ";
+                        names += def.name();
+                    });
+
+                    ImGui::Text("Report %u, %u slots of %s: %s", array.report_id, array.count,
+                        HID::Descriptor::usage_page_name(array.usage_page), names.empty() ? "(none)" : names.c_str());
+                }
+            }
+
             if (ImGui::CollapsingHeader("Outputs")) {
                 static int value = 0;
                 for ( auto output : desc.outputs ) {
-                    auto def = HID::Descriptor::find_usage_definition(output.usage_page, output.usage_id);
+                    const auto &def = HID::Descriptor::find_usage_definition(output.usage_page, output.usage_id);
 
-                    if (ImGui::InputInt(def.name, &value)) {
+                    if (ImGui::InputInt(def.name(), &value)) {
                         if (value > output.max_value) value = output.max_value;
                         if (value < output.min_value) value = output.min_value;
                     }
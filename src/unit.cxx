@@ -1,11 +1,74 @@
 #include "unit.hxx"
 
+#include <fmt/format.h>
+
 namespace HID {
-    Unit::Unit(int32_t unit, int32_t exp) {
-        
+
+    namespace {
+
+        const size_t DIMENSIONS = 6;
+
+        // Base unit of each dimension, by system (SI linear, SI rotation, English linear, English rotation)
+        const char *UNIT_NAMES[4][DIMENSIONS] = {
+            { "cm", "g", "s", "K", "A", "cd" },
+            { "rad", "g", "s", "K", "A", "cd" },
+            { "in", "slug", "s", "degF", "A", "cd" },
+            { "deg", "slug", "s", "degF", "A", "cd" },
+        };
+
+        int8_t nibble(uint32_t value, uint32_t index) {
+            int8_t bits = (int8_t)((value >> (index * 4)) & 0xF);
+
+            return bits >= 8 ? bits - 16 : bits;
+        }
     }
 
-    std::string Unit::to_string() {
-        return "";
+    Unit::Unit(int32_t unit, int32_t exp) : unit((uint32_t)unit), exp(decode_exponent(exp)) {}
+
+    int8_t Unit::decode_exponent(int32_t data) {
+        if (data >= -8 && data <= 7) return (int8_t)data;
+
+        return nibble((uint32_t)data, 0);
+    }
+
+    Unit::System Unit::system() const {
+        return (System)(unit & 0xF);
+    }
+
+    int8_t Unit::exponent(Dimension dimension) const {
+        return nibble(unit, 1 + (uint32_t)dimension);
+    }
+
+    bool Unit::empty() const {
+        System units = system();
+
+        return units == System::None || units == System::Vendor || (unit >> 4) == 0;
+    }
+
+    std::string Unit::to_string(bool with_scale) const {
+        if (empty()) return "";
+
+        // Reserved systems still have exponents, just no names to go with them
+        uint8_t index = (uint8_t)system();
+        if (index > (uint8_t)System::EnglishRotation) return fmt::format("unit 0x{:08x}", unit);
+
+        std::string text;
+
+        if (with_scale && exp != 0) text = fmt::format("10^{} ", exp);
+
+        bool first = true;
+
+        for (size_t dimension = 0; dimension < DIMENSIONS; dimension++) {
+            int8_t power = exponent((Dimension)dimension);
+            if (power == 0) continue;
+
+            if (!first) text += ' ';
+            first = false;
+
+            text += UNIT_NAMES[index - 1][dimension];
+            if (power != 1) text += fmt::format("^{}", power);
+        }
+
+        return text;
     }
 }
\ No newline at end of file
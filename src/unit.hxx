@@ -5,9 +5,66 @@
 
 namespace HID
 {
+    /**
+     * The unit of a field (its UNIT global item), and the power of ten its physical
+     * values are scaled by (its UNIT_EXPONENT).
+     *
+     * The unit packs eight nibbles: the system in the lowest, then the signed exponents
+     * of length, mass, time, temperature, current and luminous intensity. 0xE111, for
+     * example, is cm g s^-2 in the SI linear system: a dyne, or 10^-5 newtons.
+     */
     class Unit {
         public:
+            enum class System : uint8_t {
+                None = 0x0,
+                SILinear = 0x1,
+                SIRotation = 0x2,
+                EnglishLinear = 0x3,
+                EnglishRotation = 0x4,
+                Vendor = 0xF,
+            };
+
+            enum class Dimension : uint8_t {
+                Length,
+                Mass,
+                Time,
+                Temperature,
+                Current,
+                LuminousIntensity,
+            };
+
+            Unit() = default;
             Unit(int32_t unit, int32_t exp);
-            std::string to_string();
+
+            System system() const;
+
+            // Power of the given dimension, -8 to 7
+            int8_t exponent(Dimension dimension) const;
+
+            // Power of ten physical values are scaled by, -8 to 7
+            int8_t scale() const { return exp; }
+
+            // Whether the field has no unit, so its values are plain numbers
+            bool empty() const;
+
+            /**
+             * The unit written out, such as "10^-2 deg" or "cm g s^-2", with the dimensions in
+             * the order their nibbles come. Empty if the field has no unit.
+             *
+             * Without `with_scale` the power of ten is left out, for values it's already been applied to.
+             */
+            std::string to_string(bool with_scale = true) const;
+
+            /**
+             * Turn a UNIT_EXPONENT item's data into a power of ten.
+             *
+             * The exponent is a 4-bit two's complement value, but some devices give it
+             * as a plain signed number instead, so both are accepted.
+             */
+            static int8_t decode_exponent(int32_t data);
+
+        private:
+            uint32_t unit = 0;
+            int8_t exp = 0;
     };
 };
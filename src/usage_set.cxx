@@ -0,0 +1,105 @@
+#include "usage_set.hxx"
+
+#include <algorithm>
+
+namespace HID {
+
+    void UsageSet::resize(size_t size) {
+        length = std::min(size, MAX_ARRAY_CONTROLS);
+        words.assign((length + 63) / 64, 0);
+    }
+
+    void UsageSet::clear() {
+        std::fill(words.begin(), words.end(), 0);
+    }
+
+    size_t UsageSet::count() const {
+        size_t count = 0;
+
+        for (auto word : words) count += std::popcount(word);
+
+        return count;
+    }
+
+    void UsageSet::diff(const UsageSet &before, const UsageSet &after, UsageSet &pressed, UsageSet &released) {
+        size_t length = std::max(before.length, after.length);
+
+        if (pressed.length != length) pressed.resize(length);
+        if (released.length != length) released.resize(length);
+
+        for (size_t i = 0; i < pressed.words.size(); i++) {
+            uint64_t old = i < before.words.size() ? before.words[i] : 0;
+            uint64_t now = i < after.words.size() ? after.words[i] : 0;
+
+            pressed.words[i] = now & ~old;
+            released.words[i] = old & ~now;
+        }
+    }
+
+    namespace {
+
+        void decode_slots(const Descriptor::ArrayField &array, const unsigned char *report, size_t length, UsageSet &pressed) {
+            bool is_signed = array.logical_min < 0;
+
+            // When the last slot can be read unchecked, so can every one before it
+            if (array.count > 0 && fits_unchecked(length, array.offset + (uint64_t)(array.count - 1) * array.size, array.size)) {
+                for (uint32_t slot = 0; slot < array.count; slot++) {
+                    int32_t number = extract_bits_unchecked(report, array.offset + slot * array.size, array.size, is_signed);
+                    pressed.set((uint32_t)((int64_t)number - array.logical_min));
+                }
+
+                return;
+            }
+
+            for (uint32_t slot = 0; slot < array.count; slot++) {
+                uint32_t offset = array.offset + slot * array.size;
+
+                if (offset / 8 >= length) break;
+
+                int32_t number = extract_bits(report, length, offset, array.size, is_signed);
+
+                // Empty slots hold a value outside the logical range, which lands past `controls`
+                uint32_t index = (uint32_t)((int64_t)number - array.logical_min);
+                pressed.set(index);
+            }
+        }
+    }
+
+    void decode_array(const Descriptor::Descriptor &descriptor, const Descriptor::ArrayField &array,
+                      const unsigned char *report, size_t length, UsageSet &pressed) {
+        // Indices run from 0 at the logical minimum to the logical maximum
+        uint32_t controls = (uint32_t)std::min<int64_t>((int64_t)array.logical_max - array.logical_min + 1, MAX_ARRAY_CONTROLS);
+        if ((int64_t)array.logical_max < array.logical_min) controls = 0;
+
+        if (pressed.size() != controls) {
+            pressed.resize(controls);
+        } else {
+            pressed.clear();
+        }
+
+        if (controls == 0) return;
+
+        // Field offsets count from after the report ID
+        if (array.report_id != 0) {
+            if (length == 0) return;
+
+            report++;
+            length--;
+        }
+
+        // Byte slots on byte boundaries (keyboards, button boxes) index straight off the bytes
+        if (array.size == 8 && array.offset % 8 == 0 && array.logical_min >= 0) {
+            size_t first = array.offset / 8;
+            size_t end = first < length ? std::min<size_t>(first + array.count, length) : first;
+
+            for (size_t byte = first; byte < end; byte++) {
+                pressed.set((uint32_t)report[byte] - (uint32_t)array.logical_min);
+            }
+        } else {
+            decode_slots(array, report, length, pressed);
+        }
+
+        // Usage 0 is "no control"; on keyboards it's what empty slots hold
+        if (descriptor.array_usage(array, 0) == 0) pressed.reset(0);
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <bit>
+#include <vector>
+
+#include <stdint.h>
+
+#include "hid_descriptor.hxx"
+
+namespace HID {
+
+    // Most controls an array can index; anything past it is ignored
+    const size_t MAX_ARRAY_CONTROLS = 1 << 16;
+
+    /**
+     * The controls of an array field which are on, as one bit per control index
+     * (see `Descriptor::ArrayField`).
+     *
+     * Sets are meant to be kept and decoded into report after report, which
+     * reuses their storage rather than allocating.
+     */
+    class UsageSet {
+        public:
+            /**
+             * Make room for `size` controls, and clear them all.
+             */
+            void resize(size_t size);
+
+            void clear();
+
+            size_t size() const { return length; }
+
+            bool test(uint32_t index) const {
+                return index < length && (words[index / 64] >> (index % 64) & 1);
+            }
+
+            void set(uint32_t index) {
+                if (index < length) words[index / 64] |= 1ull << (index % 64);
+            }
+
+            void reset(uint32_t index) {
+                if (index < length) words[index / 64] &= ~(1ull << (index % 64));
+            }
+
+            // Number of controls which are on
+            size_t count() const;
+
+            bool operator==(const UsageSet &other) const = default;
+
+            /**
+             * Call `fn` with the index of each control which is on, in ascending order.
+             */
+            template <typename F>
+            void for_each(F fn) const {
+                for (size_t i = 0; i < words.size(); i++) {
+                    for (uint64_t word = words[i]; word != 0; word &= word - 1) {
+                        fn((uint32_t)(i * 64 + std::countr_zero(word)));
+                    }
+                }
+            }
+
+            /**
+             * Find the controls which came on (`pressed`) and went off (`released`) between
+             * two sets of the same array.
+             */
+            static void diff(const UsageSet &before, const UsageSet &after, UsageSet &pressed, UsageSet &released);
+
+        private:
+            std::vector<uint64_t> words;
+            size_t length = 0;
+    };
+
+    /**
+     * Decode which controls of an array field are on in a report, replacing what `pressed` held.
+     *
+     * `report` is the report as read from the device, starting with its report ID if
+     * it has one. Slots past the end of a short report are taken as empty, and usage
+     * 0 (which arrays use to mean "nothing") is never counted as on.
+     */
+    void decode_array(const Descriptor::Descriptor &descriptor, const Descriptor::ArrayField &array,
+                      const unsigned char *report, size_t length, UsageSet &pressed);
+}
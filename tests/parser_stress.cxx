@@ -0,0 +1,79 @@
+#include <atomic>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "corpus.hxx"
+#include "hid_descriptor.hxx"
+
+using namespace HID::Descriptor;
+
+// Threads parsing at once, and descriptors each of them parses
+const size_t THREADS = 8;
+const size_t PARSES = 2000;
+
+static auto members(const Node &node) {
+    return std::tie(node.usage_page, node.report_id, node.usage_id, node.designator_index, node.string_index,
+                    node.delimiter, node.report_size, node.report_index, node.min_value, node.max_value,
+                    node.physical_min, node.physical_max, node.unit, node.unit_exp, node.collection, node.flags);
+}
+
+static bool same_nodes(const std::vector<Node> &a, const std::vector<Node> &b) {
+    if (a.size() != b.size()) return false;
+
+    for (size_t i = 0; i < a.size(); i++) {
+        if (members(a[i]) != members(b[i])) return false;
+    }
+
+    return true;
+}
+
+static bool same_descriptor(const Descriptor &a, const Descriptor &b) {
+    return same_nodes(a.inputs, b.inputs) && same_nodes(a.outputs, b.outputs) && same_nodes(a.features, b.features)
+        && a.layouts.size() == b.layouts.size() && a.layout_fields == b.layout_fields && boost::num_vertices(a.collections) == boost::num_vertices(b.collections)
+        && a.arrays.size() == b.arrays.size() && a.array_usages == b.array_usages;
+}
+
+/**
+ * Many threads parse the corpus at once, half through a `Parser` of their own which
+ * they reuse, half through the free `parse`. Parsers share no state, so every
+ * result must be the same as parsing the descriptor alone. Built with
+ * ThreadSanitizer (FFBTOOL_TSAN) this also shows nothing is shared behind the scenes.
+ */
+int main() {
+    const size_t corpus_size = std::size(Bench::corpus);
+
+    std::vector<Descriptor> expected;
+    for (auto &entry : Bench::corpus) expected.push_back(parse(entry.data, entry.length));
+
+    std::atomic<size_t> mismatches = 0;
+    std::vector<std::thread> threads;
+
+    for (size_t t = 0; t < THREADS; t++) {
+        threads.emplace_back([&, t] {
+            Parser parser;
+
+            for (size_t i = 0; i < PARSES; i++) {
+                size_t index = (i + t) % corpus_size;
+                auto &entry = Bench::corpus[index];
+
+                Descriptor actual = i % 2 ? parser.parse(entry.data, entry.length) : parse(entry.data, entry.length);
+
+                if (!same_descriptor(actual, expected[index])) mismatches.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    for (auto &thread : threads) thread.join();
+
+    fmt::print("{} parses on {} threads, {} differed from parsing alone\n", THREADS * PARSES, THREADS, mismatches.load());
+
+    if (mismatches.load() != 0) {
+        fmt::print("FAILED\n");
+        return 1;
+    }
+
+    return 0;
+}
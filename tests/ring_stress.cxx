@@ -0,0 +1,105 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <string.h>
+
+#include <fmt/format.h>
+
+#include "ring.hxx"
+
+using namespace HID;
+
+// Reports the producer pushes, and threads reading them back while it does
+const uint64_t REPORTS = 1000000;
+const size_t READERS = 3;
+
+// Small enough that readers are constantly racing the producer reclaiming reports
+const size_t CAPACITY = 32;
+const size_t MAX_LENGTH = 40;
+
+/**
+ * Length of report `sequence`, varied so that reports wrap the arena at every offset.
+ */
+static int length_for(uint64_t sequence) {
+    return (int)((sequence * 2654435761u) % (MAX_LENGTH + 1));
+}
+
+/**
+ * Whether a report read back is exactly the one pushed as `sequence`: its length,
+ * its stamp, and every byte of it.
+ */
+static bool intact(uint64_t sequence, const DeviceBuffer &report) {
+    if (report.length != length_for(sequence) || report.arrival != sequence || report.latency != (uint32_t)sequence) return false;
+    if (report.queued != (sequence % 2 == 0)) return false;
+
+    for (int i = 0; i < report.length; i++) {
+        if (report.buffer[i] != (unsigned char)(sequence + i)) return false;
+    }
+
+    return true;
+}
+
+/**
+ * One producer pushes reports of every length while several readers copy them out
+ * of the ring. Every report a reader gets must be whole: the seqlock may make it
+ * skip reports, but never hand back a torn one. Built with ThreadSanitizer
+ * (FFBTOOL_TSAN) this also checks the ring's accesses are all properly ordered.
+ */
+int main() {
+    ReportRing ring(CAPACITY, MAX_LENGTH);
+
+    std::atomic<bool> done = false;
+    std::atomic<uint64_t> torn = 0, read = 0;
+
+    std::vector<std::thread> readers;
+
+    for (size_t i = 0; i < READERS; i++) {
+        readers.emplace_back([&] {
+            uint64_t seen = 0;
+
+            while (!done.load(std::memory_order_acquire)) {
+                uint64_t head = ring.head();
+
+                ring.for_each(head > CAPACITY ? head - CAPACITY : 0, head, [&](uint64_t sequence, const DeviceBuffer &report) {
+                    if (!intact(sequence, report)) torn.fetch_add(1, std::memory_order_relaxed);
+                    seen++;
+                });
+
+                DeviceBuffer latest;
+                if (ring.latest(latest) && latest.length > (int)MAX_LENGTH) torn.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            read.fetch_add(seen, std::memory_order_relaxed);
+        });
+    }
+
+    unsigned char buffer[BUFFER_SIZE];
+
+    for (uint64_t sequence = 0; sequence < REPORTS; sequence++) {
+        int length = length_for(sequence);
+        for (int i = 0; i < length; i++) buffer[i] = (unsigned char)(sequence + i);
+
+        ring.push(buffer, length, sequence, (uint32_t)sequence, sequence % 2 == 0);
+    }
+
+    done.store(true, std::memory_order_release);
+    for (auto &reader : readers) reader.join();
+
+    // With the producer stopped, the whole of the last `CAPACITY` reports must still be there
+    size_t held = 0;
+    bool history_intact = true;
+
+    ring.for_each(REPORTS - CAPACITY, REPORTS, [&](uint64_t sequence, const DeviceBuffer &report) {
+        history_intact &= intact(sequence, report);
+        held++;
+    });
+
+    fmt::print("{} reports pushed, {} read back, {} torn, {} of {} held at the end\n", REPORTS, read.load(), torn.load(), held, CAPACITY);
+
+    if (torn.load() != 0 || held != CAPACITY || !history_intact) {
+        fmt::print("FAILED\n");
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include <stdint.h>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "hid_descriptor.hxx"
+
+using namespace HID::Descriptor;
+
+// A joystick with 6 axes declared as one range, X (0x30) to Rz (0x35)
+static const unsigned char axes[] = {
+    0x05, 0x01,       // Usage Page (Generic Desktop)
+    0x09, 0x04,       // Usage (Joystick)
+    0xa1, 0x01,       // Collection (Application)
+    0x19, 0x30,       //   Usage Minimum (X)
+    0x29, 0x35,       //   Usage Maximum (Rz)
+    0x15, 0x00,       //   Logical Minimum (0)
+    0x26, 0xff, 0x00, //   Logical Maximum (255)
+    0x75, 0x08,       //   Report Size (8)
+    0x95, 0x06,       //   Report Count (6)
+    0x81, 0x02,       //   Input (Data, Variable, Absolute)
+    0xc0,             // End Collection
+};
+
+// 4 buttons whose range starts at usage 0, with 2 fields past its end
+static const unsigned char from_zero[] = {
+    0x05, 0x09,       // Usage Page (Button)
+    0x09, 0x00,       // Usage (0)
+    0xa1, 0x01,       // Collection (Application)
+    0x19, 0x00,       //   Usage Minimum (0)
+    0x29, 0x03,       //   Usage Maximum (3)
+    0x15, 0x00,       //   Logical Minimum (0)
+    0x25, 0x01,       //   Logical Maximum (1)
+    0x75, 0x01,       //   Report Size (1)
+    0x95, 0x06,       //   Report Count (6)
+    0x81, 0x02,       //   Input (Data, Variable, Absolute)
+    0x75, 0x02,       //   Report Size (2)
+    0x95, 0x01,       //   Report Count (1)
+    0x81, 0x01,       //   Input (Constant)
+    0xc0,             // End Collection
+};
+
+/**
+ * Whether the first inputs of `descriptor` have exactly the usages `expected`, in order.
+ */
+static bool usages_are(const char *name, const Descriptor &descriptor, const std::vector<uint16_t> &expected) {
+    bool same = descriptor.inputs.size() >= expected.size();
+
+    for (size_t i = 0; same && i < expected.size(); i++) {
+        same = descriptor.inputs[i].usage_id == expected[i];
+    }
+
+    fmt::print("{}: ", name);
+    for (auto &node : descriptor.inputs) fmt::print("{:#04x} ", node.usage_id);
+    fmt::print("{}\n", same ? "ok" : "WRONG");
+
+    return same;
+}
+
+/**
+ * Fields declared by a Usage Minimum/Maximum pair take the range's usages in
+ * order, one each, with any fields past its end taking the last. A range is one
+ * even when it starts at usage 0.
+ */
+int main() {
+    bool ok = true;
+
+    ok &= usages_are("X..Rz", parse(axes, sizeof(axes)), {0x30, 0x31, 0x32, 0x33, 0x34, 0x35});
+    ok &= usages_are("0..3", parse(from_zero, sizeof(from_zero)), {0, 1, 2, 3, 3, 3});
+
+    if (!ok) {
+        fmt::print("FAILED\n");
+        return 1;
+    }
+
+    return 0;
+}